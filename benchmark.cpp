@@ -0,0 +1,736 @@
+#include "binary_search_tree.h"
+#include "sharded_tree.h"
+#include "durable_tree.h"
+#include "static_tree.h"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <thread>
+#include <mutex>
+
+/**
+ * @brief Funtore predicato di uguaglianza tra due interi
+ *
+ */
+struct equals_int{
+    bool operator()(int a, int b) const{
+        return a==b;
+    }
+};
+/**
+ * @brief Funtore di comparazione tra due interi
+ *
+ */
+struct compare_int{
+    bool operator()(int a, int b) const{
+        return a < b;
+    }
+};
+
+/**
+ * @brief Politica splay
+ *
+ */
+struct splay_policy : tree_policy{
+    typedef splay_access access;
+};
+/**
+ * @brief Politica transpose
+ *
+ */
+struct transpose_policy : tree_policy{
+    typedef transpose_access access;
+};
+/**
+ * @brief Politica con riepiloghi somma
+ *
+ */
+struct sum_policy : tree_policy{
+    typedef sum_aggregate<long long> aggregate;
+};
+struct lru_policy : tree_policy{
+    typedef lru_eviction eviction;
+};
+
+typedef binary_search_tree<int, equals_int, compare_int> int_tree;
+typedef binary_search_tree<int, equals_int, compare_int, splay_policy> splay_tree;
+typedef binary_search_tree<int, equals_int, compare_int, transpose_policy> transpose_tree;
+typedef binary_search_tree<int, equals_int, compare_int, sum_policy> sum_tree;
+typedef binary_search_tree<int, equals_int, compare_int, lru_policy> lru_tree;
+
+/**
+ * @brief Ritorna i secondi trascorsi da start
+ *
+ * @param start istante di inizio della misura
+ * @return double secondi trascorsi
+ */
+double elapsed(const std::chrono::steady_clock::time_point &start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Riempie un albero con n interi pari inseriti in ordine casuale
+ *
+ * @param tree albero da riempire
+ * @param n numero di valori
+ * @param rng generatore di numeri casuali
+ */
+template<typename Tree>
+void fill_random_tree(Tree &tree, unsigned int n, std::mt19937 &rng){
+    std::vector<int> values(n);
+    for(unsigned int i = 0; i < n; ++i)
+        values[i] = 2 * i;
+    std::shuffle(values.begin(), values.end(), rng);
+    for(unsigned int i = 0; i < n; ++i)
+        tree.add(values[i]);
+}
+
+/**
+ * @brief Confronta contains ripetuto con contains_batch su un albero di n nodi
+ *
+ * @param n numero di nodi dell'albero
+ * @param lookups numero di ricerche
+ * @param rng generatore di numeri casuali
+ */
+void bench_batch_lookup(unsigned int n, unsigned int lookups, std::mt19937 &rng){
+    std::cout<<"***** BENCH CONTAINS vs CONTAINS_BATCH ("<<n<<" nodes) *****"<<std::endl;
+    int_tree tree;
+    fill_random_tree(tree, n, rng);
+    std::uniform_int_distribution<int> dist(0, 2 * n);
+    std::vector<int> keys(lookups);
+    for(unsigned int i = 0; i < lookups; ++i)
+        keys[i] = dist(rng);
+
+    std::vector<char> found(lookups);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < lookups; ++i)
+        found[i] = tree.contains(keys[i]);
+    double loop = elapsed(start);
+
+    std::vector<char> found_batch(lookups);
+    start = std::chrono::steady_clock::now();
+    tree.contains_batch(keys.begin(), keys.end(), found_batch.begin());
+    double batch = elapsed(start);
+
+    if(found != found_batch)
+        std::cout<<"ERROR: contains_batch disagrees with contains"<<std::endl;
+    std::cout<<"contains:       "<<lookups / loop / 1e6<<" Mlookups/s"<<std::endl;
+    std::cout<<"contains_batch: "<<lookups / batch / 1e6<<" Mlookups/s"<<std::endl;
+}
+
+/**
+ * @brief Genera chiavi con distribuzione di Zipf sui valori di un albero di n nodi
+ *
+ * Il rango di popolarità è assegnato ai valori in ordine casuale, così le
+ * chiavi più cercate si trovano a profondità qualsiasi
+ *
+ * @param n numero di valori distinti
+ * @param count numero di chiavi da generare
+ * @param s esponente della distribuzione
+ * @param rng generatore di numeri casuali
+ * @return std::vector<int> chiavi generate
+ */
+std::vector<int> zipf_keys(unsigned int n, unsigned int count, double s, std::mt19937 &rng){
+    std::vector<double> cdf(n);
+    double total = 0;
+    for(unsigned int i = 0; i < n; ++i){
+        total += 1.0 / std::pow(i + 1.0, s);
+        cdf[i] = total;
+    }
+    std::vector<int> by_rank(n);
+    for(unsigned int i = 0; i < n; ++i)
+        by_rank[i] = 2 * i;
+    std::shuffle(by_rank.begin(), by_rank.end(), rng);
+
+    std::uniform_real_distribution<double> dist(0, total);
+    std::vector<int> keys(count);
+    for(unsigned int i = 0; i < count; ++i){
+        unsigned int rank = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+        keys[i] = by_rank[std::min(rank, n - 1)];
+    }
+    return keys;
+}
+
+/**
+ * @brief Misura contains su un albero riempito in ordine casuale
+ *
+ * @return double milioni di ricerche al secondo
+ */
+template<typename Tree>
+double time_contains(unsigned int n, const std::vector<int> &keys){
+    std::mt19937 rng(7);
+    Tree tree;
+    fill_random_tree(tree, n, rng);
+    unsigned int hits = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < keys.size(); ++i)
+        hits += tree.contains(keys[i]);
+    double t = elapsed(start);
+    if(hits != keys.size())
+        std::cout<<"ERROR: missing keys"<<std::endl;
+    return keys.size() / t / 1e6;
+}
+
+/**
+ * @brief Confronta l'albero statico con le politiche di accesso adattive su chiavi Zipf
+ *
+ * @param n numero di nodi dell'albero
+ * @param lookups numero di ricerche
+ * @param rng generatore di numeri casuali
+ */
+void bench_zipf_access(unsigned int n, unsigned int lookups, std::mt19937 &rng){
+    std::cout<<"***** BENCH ZIPF LOOKUPS: STATIC vs SPLAY vs TRANSPOSE ("<<n<<" nodes) *****"<<std::endl;
+    std::vector<int> keys = zipf_keys(n, lookups, 1.2, rng);
+    std::cout<<"static:    "<<time_contains<int_tree>(n, keys)<<" Mlookups/s"<<std::endl;
+    std::cout<<"splay:     "<<time_contains<splay_tree>(n, keys)<<" Mlookups/s"<<std::endl;
+    std::cout<<"transpose: "<<time_contains<transpose_tree>(n, keys)<<" Mlookups/s"<<std::endl;
+}
+
+/**
+ * @brief Misura una visita completa con const_iterator e n ricerche casuali
+ *
+ * @param tree albero da misurare
+ * @param keys chiavi da cercare
+ * @param label etichetta da stampare
+ */
+void time_scan_and_lookups(const int_tree &tree, const std::vector<int> &keys, const char *label){
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for(int_tree::const_iterator b = tree.begin(), e = tree.end(); b != e; ++b)
+        sum += *b;
+    double scan = elapsed(start);
+
+    start = std::chrono::steady_clock::now();
+    unsigned int hits = 0;
+    for(unsigned int i = 0; i < keys.size(); ++i)
+        hits += tree.contains(keys[i]);
+    double lookup = elapsed(start);
+    std::cout<<label<<" scan: "<<scan * 1e3<<" ms, lookups: "<<keys.size() / lookup / 1e6
+             <<" Mlookups/s (checksum "<<sum + hits<<")"<<std::endl;
+}
+
+/**
+ * @brief Misura visita e ricerche prima e dopo compact() su un albero
+ * dopo molti inserimenti e rimozioni alternati
+ *
+ * @param n numero di nodi dell'albero
+ * @param lookups numero di ricerche
+ * @param rng generatore di numeri casuali
+ */
+void bench_compact(unsigned int n, unsigned int lookups, std::mt19937 &rng){
+    std::cout<<"***** BENCH COMPACT AFTER CHURN ("<<n<<" nodes) *****"<<std::endl;
+    int_tree tree;
+    fill_random_tree(tree, n, rng);
+    std::uniform_int_distribution<int> dist(0, 2 * n);
+    for(unsigned int i = 0; i < n; ++i){
+        int v = dist(rng);
+        if(!tree.remove(v))
+            tree.add(v);
+    }
+    std::vector<int> keys(lookups);
+    for(unsigned int i = 0; i < lookups; ++i)
+        keys[i] = dist(rng);
+
+    time_scan_and_lookups(tree, keys, "before compact:          ");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    tree.compact();
+    std::cout<<"compact(in_order):        "<<elapsed(start) * 1e3<<" ms"<<std::endl;
+    time_scan_and_lookups(tree, keys, "after in-order compact:  ");
+    tree.compact(int_tree::pre_order_layout);
+    time_scan_and_lookups(tree, keys, "after pre-order compact: ");
+}
+
+/**
+ * @brief Confronta add con cattura di existing_node_exception e try_add
+ * su un flusso composto quasi solo da duplicati
+ *
+ * @param n numero di nodi dell'albero
+ * @param adds numero di inserimenti
+ * @param rng generatore di numeri casuali
+ */
+void bench_duplicate_adds(unsigned int n, unsigned int adds, std::mt19937 &rng){
+    std::cout<<"***** BENCH DUPLICATE ADDS: ADD+CATCH vs TRY_ADD ("<<n<<" nodes) *****"<<std::endl;
+    int_tree tree;
+    fill_random_tree(tree, n, rng);
+    std::uniform_int_distribution<int> dist(0, n - 1);
+    std::vector<int> keys(adds);
+    for(unsigned int i = 0; i < adds; ++i)
+        keys[i] = 2 * dist(rng);
+
+    int_tree copy(tree);
+    unsigned int duplicates = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < adds; ++i){
+        try{
+            copy.add(keys[i]);
+        }catch(const existing_node_exception &){
+            ++duplicates;
+        }
+    }
+    double with_catch = elapsed(start);
+
+    unsigned int try_duplicates = 0;
+    start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < adds; ++i)
+        try_duplicates += tree.try_add(keys[i]) == int_tree::add_duplicate;
+    double with_status = elapsed(start);
+
+    if(duplicates != try_duplicates)
+        std::cout<<"ERROR: try_add disagrees with add"<<std::endl;
+    std::cout<<"add+catch: "<<adds / with_catch / 1e6<<" Madds/s"<<std::endl;
+    std::cout<<"try_add:   "<<adds / with_status / 1e6<<" Madds/s"<<std::endl;
+}
+
+/**
+ * @brief Misura la costruzione bilanciata di un albero vuoto con add_batch e la sua copia
+ * 
+ * Entrambe si dividono su hardware_concurrency() thread
+ *
+ * @param n numero di nodi dell'albero
+ * @param rng generatore di numeri casuali
+ */
+void bench_parallel_build(unsigned int n, std::mt19937 &rng){
+    std::cout<<"***** BENCH PARALLEL BUILD / COPY ("<<n<<" nodes, "<<std::thread::hardware_concurrency()<<" cores) *****"<<std::endl;
+    std::vector<int> values(n);
+    for(unsigned int i = 0; i < n; ++i)
+        values[i] = 2 * i;
+    std::shuffle(values.begin(), values.end(), rng);
+
+    int_tree tree;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    tree.add_batch(values.begin(), values.end());
+    std::cout<<"add_batch: "<<elapsed(start) * 1e3<<" ms"<<std::endl;
+
+    start = std::chrono::steady_clock::now();
+    int_tree copy(tree);
+    std::cout<<"copy:      "<<elapsed(start) * 1e3<<" ms"<<std::endl;
+    if(copy.size() != tree.size())
+        std::cout<<"ERROR: copy size differs"<<std::endl;
+}
+
+/**
+ * @brief Confronta contains senza e con il filtro di appartenenza su ricerche
+ * che per metà riguardano valori assenti
+ *
+ * @param n numero di nodi dell'albero
+ * @param lookups numero di ricerche
+ * @param rng generatore di numeri casuali
+ */
+void bench_filtered_misses(unsigned int n, unsigned int lookups, std::mt19937 &rng){
+    std::cout<<"***** BENCH CONTAINS WITH MEMBERSHIP FILTER ("<<n<<" nodes, 50% misses) *****"<<std::endl;
+    int_tree tree;
+    fill_random_tree(tree, n, rng);
+    std::uniform_int_distribution<int> dist(0, 2 * n - 1);
+    std::vector<int> keys(lookups);
+    for(unsigned int i = 0; i < lookups; ++i)
+        keys[i] = dist(rng);
+
+    unsigned int found = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < lookups; ++i)
+        found += tree.contains(keys[i]);
+    double plain = elapsed(start);
+
+    tree.enable_filter(0.01);
+    unsigned int filtered_found = 0;
+    start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < lookups; ++i)
+        filtered_found += tree.contains(keys[i]);
+    double filtered = elapsed(start);
+
+    if(found != filtered_found)
+        std::cout<<"ERROR: the filter changed the result of contains"<<std::endl;
+    filter_stats stats = tree.filter_statistics();
+    std::cout<<"contains:          "<<lookups / plain / 1e6<<" Mlookups/s"<<std::endl;
+    std::cout<<"contains + filter: "<<lookups / filtered / 1e6<<" Mlookups/s ("
+             <<stats.filtered<<" filtered, "<<stats.false_positives<<" false positives)"<<std::endl;
+}
+
+/**
+ * @brief Confronta la somma su intervalli di chiavi calcolata iterando con
+ * quella calcolata da aggregate(a, b) sui riepiloghi dei sotto-alberi
+ *
+ * @param n numero di nodi dell'albero
+ * @param queries numero di intervalli
+ * @param rng generatore di numeri casuali
+ */
+void bench_range_aggregate(unsigned int n, unsigned int queries, std::mt19937 &rng){
+    std::cout<<"***** BENCH RANGE SUM: ITERATION vs AGGREGATE ("<<n<<" nodes) *****"<<std::endl;
+    sum_tree tree;
+    fill_random_tree(tree, n, rng);
+    std::uniform_int_distribution<int> dist(0, 2 * n - 1);
+    std::vector<std::pair<int, int> > ranges(queries);
+    for(unsigned int i = 0; i < queries; ++i){
+        int a = dist(rng), b = dist(rng);
+        ranges[i] = std::make_pair(std::min(a, b), std::max(a, b));
+    }
+
+    long long iterated = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < queries; ++i)
+        for(sum_tree::const_iterator it = tree.lower_bound(ranges[i].first); it != tree.end() && *it <= ranges[i].second; ++it)
+            iterated += *it;
+    double with_iteration = elapsed(start);
+
+    long long aggregated = 0;
+    start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < queries; ++i)
+        aggregated += tree.aggregate(ranges[i].first, ranges[i].second);
+    double with_aggregate = elapsed(start);
+
+    if(iterated != aggregated)
+        std::cout<<"ERROR: aggregate disagrees with iteration"<<std::endl;
+    std::cout<<"iteration: "<<queries / with_iteration<<" queries/s"<<std::endl;
+    std::cout<<"aggregate: "<<queries / with_aggregate<<" queries/s"<<std::endl;
+}
+
+/**
+ * @brief Confronta gli inserimenti da più thread in un unico albero protetto da
+ * un mutex e in un sharded_tree
+ *
+ * @param n numero di valori inseriti
+ * @param rng generatore di numeri casuali
+ */
+void bench_sharded_writes(unsigned int n, std::mt19937 &rng){
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout<<"***** BENCH CONCURRENT ADDS: LOCKED TREE vs SHARDED TREE ("<<n<<" values, "<<threads<<" threads) *****"<<std::endl;
+    std::vector<int> values(n);
+    for(unsigned int i = 0; i < n; ++i)
+        values[i] = 2 * i;
+    std::shuffle(values.begin(), values.end(), rng);
+
+    int_tree tree;
+    std::mutex mutex;
+    std::vector<std::thread> workers;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned int t = 0; t < threads; ++t)
+        workers.push_back(std::thread([&, t](){
+            for(unsigned int i = t; i < n; i += threads){
+                std::lock_guard<std::mutex> lock(mutex);
+                tree.add(values[i]);
+            }
+        }));
+    for(unsigned int t = 0; t < threads; ++t)
+        workers[t].join();
+    double locked = elapsed(start);
+
+    sharded_tree<int, equals_int, compare_int> shards(threads);
+    workers.clear();
+    start = std::chrono::steady_clock::now();
+    for(unsigned int t = 0; t < threads; ++t)
+        workers.push_back(std::thread([&, t](){
+            for(unsigned int i = t; i < n; i += threads)
+                shards.add(values[i]);
+        }));
+    for(unsigned int t = 0; t < threads; ++t)
+        workers[t].join();
+    double sharded = elapsed(start);
+
+    if(tree.size() != shards.size())
+        std::cout<<"ERROR: sharded_tree size differs"<<std::endl;
+    std::cout<<"locked tree:  "<<n / locked / 1e6<<" Madds/s"<<std::endl;
+    std::cout<<"sharded tree: "<<n / sharded / 1e6<<" Madds/s ("<<shards.shard_count()<<" shards)"<<std::endl;
+}
+
+/**
+ * @brief Misura come cresce il throughput di un sharded_tree con il numero dei
+ * thread: ogni thread esegue lo stesso numero di operazioni (tre ricerche e un
+ * inserimento su chiavi casuali), quindi con più core il tempo resta simile e
+ * le operazioni al secondo aumentano
+ *
+ * @param n numero di valori iniziali
+ * @param ops numero di operazioni per thread
+ * @param rng generatore di numeri casuali
+ */
+void bench_sharded_scaling(unsigned int n, unsigned int ops, std::mt19937 &rng){
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout<<"***** BENCH SHARDED TREE SCALING ("<<n<<" values, "<<ops<<" ops per thread, "<<cores<<" cores) *****"<<std::endl;
+    unsigned int max_threads = std::max(4u, cores);
+    sharded_tree<int, equals_int, compare_int> shards(max_threads);
+    std::vector<int> values(n);
+    for(unsigned int i = 0; i < n; ++i)
+        values[i] = 2 * i;
+    std::shuffle(values.begin(), values.end(), rng);
+    for(unsigned int i = 0; i < n; ++i)
+        shards.add(values[i]);
+    shards.repartition();
+
+    std::vector<unsigned int> seeds(max_threads);
+    for(unsigned int t = 0; t < max_threads; ++t)
+        seeds[t] = rng();
+    for(unsigned int threads = 1; threads <= max_threads; threads *= 2){
+        std::vector<std::thread> workers;
+        std::atomic<unsigned int> found(0);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(unsigned int t = 0; t < threads; ++t)
+            workers.push_back(std::thread([&, t](){
+                std::mt19937 local(seeds[t]);
+                unsigned int hits = 0;
+                for(unsigned int i = 0; i < ops; ++i){
+                    int key = static_cast<int>(local() % (4 * n));
+                    if(i % 4 == 3)
+                        shards.try_add(key);
+                    else
+                        hits += shards.contains(key);
+                }
+                found += hits;
+            }));
+        for(unsigned int t = 0; t < threads; ++t)
+            workers[t].join();
+        double time = elapsed(start);
+        std::cout<<threads<<" threads: "<<static_cast<double>(threads) * ops / time / 1e6<<" Mops/s"<<std::endl;
+    }
+}
+
+/**
+ * @brief Misura la scrittura con group commit, il checkpoint e il ripristino
+ * di un durable_tree, confrontato con la ricostruzione tramite add
+ *
+ * @param n numero di valori
+ * @param rng generatore di numeri casuali
+ */
+void bench_durable_recovery(unsigned int n, std::mt19937 &rng){
+    std::cout<<"***** BENCH DURABLE TREE: JOURNAL, CHECKPOINT, RECOVERY ("<<n<<" values) *****"<<std::endl;
+    std::vector<int> values(n);
+    for(unsigned int i = 0; i < n; ++i)
+        values[i] = 2 * i;
+    std::shuffle(values.begin(), values.end(), rng);
+    {
+        durable_tree<int, equals_int, compare_int> tree("bench_durable", 1024, std::size_t(-1));
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(unsigned int i = 0; i < n; ++i)
+            tree.add(values[i]);
+        tree.sync();
+        std::cout<<"journaled adds: "<<n / elapsed(start) / 1e6<<" Madds/s"<<std::endl;
+        start = std::chrono::steady_clock::now();
+        tree.checkpoint();
+        std::cout<<"checkpoint:     "<<elapsed(start) * 1e3<<" ms"<<std::endl;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    durable_tree<int, equals_int, compare_int> tree("bench_durable");
+    std::cout<<"recovery:       "<<elapsed(start) * 1e3<<" ms"<<std::endl;
+
+    start = std::chrono::steady_clock::now();
+    int_tree rebuilt;
+    for(unsigned int i = 0; i < n; ++i)
+        rebuilt.add(values[i]);
+    std::cout<<"add rebuild:    "<<elapsed(start) * 1e3<<" ms"<<std::endl;
+    if(rebuilt.size() != tree.size())
+        std::cout<<"ERROR: recovered size differs"<<std::endl;
+    std::remove("bench_durable/journal");
+    std::remove("bench_durable/snapshot");
+    std::remove("bench_durable");
+}
+
+/**
+ * @brief Confronta l'estrazione del minimo con remove(*begin()) e con pop_min
+ *
+ * @param n numero di nodi dell'albero
+ * @param pops numero di estrazioni (al più n)
+ * @param rng generatore di numeri casuali
+ */
+void bench_priority_queue(unsigned int n, unsigned int pops, std::mt19937 &rng){
+    std::cout<<"***** BENCH PRIORITY QUEUE: REMOVE(*BEGIN()) vs POP_MIN ("<<n<<" nodes) *****"<<std::endl;
+    int_tree tree;
+    fill_random_tree(tree, n, rng);
+    int_tree copy(tree);
+
+    long long removed = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < pops; ++i){
+        int value = *tree.begin();
+        tree.remove(value);
+        removed += value;
+    }
+    double with_remove = elapsed(start);
+
+    long long popped = 0;
+    start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < pops; ++i)
+        popped += copy.pop_min();
+    double with_pop = elapsed(start);
+
+    if(removed != popped)
+        std::cout<<"ERROR: pop_min disagrees with remove"<<std::endl;
+    std::cout<<"remove(*begin()): "<<pops / with_remove / 1e6<<" Mpops/s"<<std::endl;
+    std::cout<<"pop_min:          "<<pops / with_pop / 1e6<<" Mpops/s"<<std::endl;
+}
+
+/**
+ * @brief Confronta le ricerche in una piccola tabella fissa memorizzata in un
+ * binary_search_tree e in uno static_tree
+ *
+ * @param lookups numero di ricerche
+ * @param rng generatore di numeri casuali
+ */
+void bench_static_table(unsigned int lookups, std::mt19937 &rng){
+    const std::size_t table = 255;
+    std::cout<<"***** BENCH FIXED TABLE: BINARY SEARCH TREE vs STATIC TREE ("<<table<<" keys) *****"<<std::endl;
+    int keys[table];
+    for(std::size_t i = 0; i < table; ++i)
+        keys[i] = 3 * i;
+    std::shuffle(keys, keys + table, rng);
+    int_tree tree;
+    for(std::size_t i = 0; i < table; ++i)
+        tree.add(keys[i]);
+    const static_tree<int, table, equals_int, compare_int> fixed(keys);
+    std::uniform_int_distribution<int> dist(0, 3 * table);
+    std::vector<int> probes(lookups);
+    for(unsigned int i = 0; i < lookups; ++i)
+        probes[i] = dist(rng);
+
+    unsigned int found = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < lookups; ++i)
+        found += tree.contains(probes[i]);
+    double dynamic = elapsed(start);
+
+    unsigned int fixed_found = 0;
+    start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < lookups; ++i)
+        fixed_found += fixed.contains(probes[i]);
+    double flat = elapsed(start);
+
+    if(found != fixed_found)
+        std::cout<<"ERROR: static_tree disagrees with binary_search_tree"<<std::endl;
+    std::cout<<"binary_search_tree: "<<lookups / dynamic / 1e6<<" Mlookups/s"<<std::endl;
+    std::cout<<"static_tree:        "<<lookups / flat / 1e6<<" Mlookups/s"<<std::endl;
+}
+
+/**
+ * @brief Confronta una cache a capacità limitata: albero senza eviction svuotato
+ * tutto insieme quando è pieno e albero con lru_eviction, che rimuove un nodo
+ * alla volta. Misura le operazioni al secondo, la percentuale di successi e
+ * la pausa più lunga di una singola operazione
+ *
+ * @param capacity numero massimo di valori in cache
+ * @param ops numero di operazioni (ricerca e, se assente, inserimento)
+ * @param rng generatore di numeri casuali
+ */
+void bench_lru_cache(unsigned int capacity, unsigned int ops, std::mt19937 &rng){
+    std::cout<<"***** BENCH BOUNDED CACHE: CLEAR WHEN FULL vs LRU EVICTION ("<<capacity<<" values) *****"<<std::endl;
+    std::vector<int> keys(ops);
+    for(unsigned int i = 0; i < ops; ++i){
+        // metà delle richieste su un insieme caldo grande un quarto della capacità
+        unsigned int range = rng() % 2 == 0 ? capacity / 4 : 4 * capacity;
+        keys[i] = static_cast<int>(rng() % range);
+    }
+
+    int_tree flushed;
+    unsigned int flushed_hits = 0;
+    double flushed_pause = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < ops; ++i){
+        std::chrono::steady_clock::time_point op = std::chrono::steady_clock::now();
+        if(flushed.contains(keys[i])){
+            ++flushed_hits;
+        }else{
+            if(flushed.size() == capacity)
+                flushed.clear();
+            flushed.add(keys[i]);
+        }
+        flushed_pause = std::max(flushed_pause, elapsed(op));
+    }
+    double with_flush = elapsed(start);
+
+    lru_tree lru;
+    lru.set_capacity(capacity);
+    unsigned int lru_hits = 0;
+    double lru_pause = 0;
+    start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < ops; ++i){
+        std::chrono::steady_clock::time_point op = std::chrono::steady_clock::now();
+        if(lru.contains(keys[i]))
+            ++lru_hits;
+        else
+            lru.add(keys[i]);
+        lru_pause = std::max(lru_pause, elapsed(op));
+    }
+    double with_lru = elapsed(start);
+
+    if(lru.size() > capacity)
+        std::cout<<"ERROR: the LRU cache exceeds its capacity"<<std::endl;
+    std::cout<<"clear when full: "<<ops / with_flush / 1e6<<" Mops/s, "<<100.0 * flushed_hits / ops<<"% hits, longest pause "<<flushed_pause * 1e3<<" ms"<<std::endl;
+    std::cout<<"lru_eviction:    "<<ops / with_lru / 1e6<<" Mops/s, "<<100.0 * lru_hits / ops<<"% hits, longest pause "<<lru_pause * 1e3<<" ms"<<std::endl;
+}
+
+/**
+ * @brief Confronta una scansione a pagine su un albero modificato tra una pagina
+ * e l'altra: ripresa con lower_bound dall'ultimo valore letto e ripresa con un cursore
+ *
+ * @param n numero di nodi dell'albero
+ * @param page numero di valori per pagina
+ * @param rng generatore di numeri casuali
+ */
+void bench_paginated_scan(unsigned int n, unsigned int page, std::mt19937 &rng){
+    std::cout<<"***** BENCH PAGINATED SCAN: RE-SEEK vs CURSOR ("<<n<<" nodes, pages of "<<page<<") *****"<<std::endl;
+    int_tree reseek;
+    fill_random_tree(reseek, n, rng);
+    int_tree resumed(reseek);
+    std::vector<int> changes(2 * (n / page + 1)); // le pagine crescono con i valori aggiunti
+    for(std::size_t i = 0; i < changes.size(); ++i)
+        changes[i] = static_cast<int>(rng() % (2 * n)) | 1; // valori dispari, assenti dall'albero
+
+    long long sum = 0;
+    std::size_t pages = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int_tree::const_iterator it = reseek.begin();
+    while(it != reseek.end()){
+        int last = 0;
+        for(unsigned int k = 0; k < page && it != reseek.end(); ++k, ++it){
+            last = *it;
+            sum += last;
+        }
+        reseek.try_add(changes[pages++]);
+        it = reseek.lower_bound(last + 1);
+    }
+    double with_reseek = elapsed(start);
+
+    long long cursor_sum = 0;
+    pages = 0;
+    start = std::chrono::steady_clock::now();
+    int_tree::cursor c = resumed.open_cursor();
+    while(!c.at_end()){
+        for(unsigned int k = 0; k < page && !c.at_end(); ++k, ++c)
+            cursor_sum += *c;
+        resumed.try_add(changes[pages++]);
+    }
+    double with_cursor = elapsed(start);
+
+    if(sum != cursor_sum)
+        std::cout<<"ERROR: the cursor scan disagrees with the re-seek scan"<<std::endl;
+    std::cout<<"lower_bound per page: "<<n / with_reseek / 1e6<<" Mvalues/s"<<std::endl;
+    std::cout<<"cursor:               "<<n / with_cursor / 1e6<<" Mvalues/s"<<std::endl;
+}
+
+/**
+ * @brief Benchmark della libreria
+ *
+ * Uso: benchmark.exe [numero di nodi]. Il valore di default produce un albero
+ * molto più grande della cache di ultimo livello
+ */
+int main(int argc, char *argv[]){
+    unsigned int n = 1u << 22;
+    if(argc > 1)
+        n = std::strtoul(argv[1], nullptr, 10);
+    std::mt19937 rng(42);
+
+    bench_batch_lookup(n, 1u << 21, rng);
+    bench_zipf_access(n, 1u << 22, rng);
+    bench_compact(n, 1u << 21, rng);
+    bench_duplicate_adds(n, 1u << 21, rng);
+    bench_parallel_build(n, rng);
+    bench_filtered_misses(n, 1u << 21, rng);
+    bench_range_aggregate(n, 1u << 6, rng);
+    bench_sharded_writes(n, rng);
+    bench_sharded_scaling(n, 1u << 20, rng);
+    bench_durable_recovery(n, rng);
+    bench_priority_queue(n, n / 2, rng);
+    bench_static_table(1u << 22, rng);
+    bench_lru_cache(n / 4, 1u << 22, rng);
+    bench_paginated_scan(n, 16, rng);
+    return 0;
+}
@@ -6,23 +6,352 @@
 #include <cassert>
 #include <iterator> // std::forward_iterator_tag
 #include <cstddef>  // std::ptrdiff_t
+#include <vector>
+#include <functional> // std::less
+#include <type_traits>
+#include <limits>     // std::numeric_limits
+#include <chrono>
+#include <new>        // placement new
+#include <thread>
+#include <exception>  // std::exception_ptr
+#include <string>
+#if defined(__GLIBC__)
+#include <malloc.h>   // malloc_usable_size
+#endif
 #include "existing_node_exception.h"
 #include "empty_tree_exception.h"
+#include "broken_invariant_exception.h"
+#include "bloom_filter.h"
+#include "bst_exceptions.h"
+
+#if defined(__GNUC__)
+#define BST_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define BST_PREFETCH(p) ((void)0)
+#endif
+
+/**
+ * @brief Trait che indica se il funtore di comparazione Comp equivale a operator<
+ * sul tipo T
+ * 
+ * In tal caso la ricerca usa direttamente operator<, che il compilatore può
+ * tradurre in un confronto senza salti. Può essere specializzato per funtori utente
+ * 
+ * @tparam Comp funtore di comparazione
+ * @tparam T tipo degli elementi
+ */
+template<typename Comp, typename T>
+struct is_less_comparator : std::false_type{};
+
+template<typename T>
+struct is_less_comparator<std::less<T>, T> : std::true_type{};
+
+/**
+ * @brief Trait che indica se i valori di tipo T sono chiavi piccole, cioè
+ * banalmente copiabili e grandi al più due puntatori
+ * 
+ * Le chiavi piccole vengono passate per valore lungo il cammino di ricerca
+ * 
+ * @tparam T tipo degli elementi
+ */
+template<typename T>
+struct is_small_key : std::integral_constant<bool,
+    std::is_trivially_copyable<T>::value && sizeof(T) <= 2 * sizeof(void*)>{};
+
+/**
+ * @brief Modalità in cui ogni valore compare una sola volta: aggiungere un
+ * valore già presente lancia existing_node_exception
+ */
+struct unique_keys{};
+
+/**
+ * @brief Modalità multiset: ogni nodo conta le copie del proprio valore e
+ * aggiungere un valore già presente incrementa il contatore
+ */
+struct multi_keys{};
+
+/**
+ * @brief Accesso statico: le ricerche non modificano la forma dell'albero
+ */
+struct static_access{};
+
+/**
+ * @brief Accesso adattivo: ogni ricerca andata a buon fine porta il nodo trovato
+ * nella radice tramite splay, così i valori cercati spesso restano vicini alla radice
+ */
+struct splay_access{};
+
+/**
+ * @brief Accesso adattivo economico: ogni ricerca andata a buon fine fa salire
+ * il nodo trovato di un solo livello con una rotazione
+ */
+struct transpose_access{};
+
+/**
+ * @brief Nessuna scadenza né capacità: i valori restano finché non vengono rimossi
+ */
+struct no_eviction{};
+
+/**
+ * @brief Cache ordinata con eviction del valore più vecchio: i nodi formano una
+ * lista nell'ordine di inserimento; oltre la capacità viene rimosso il primo
+ */
+struct fifo_eviction{};
+
+/**
+ * @brief Cache ordinata con eviction LRU: come fifo_eviction, ma ogni ricerca
+ * andata a buon fine sposta il nodo in fondo alla lista (come con splay_access,
+ * anche le ricerche modificano l'albero e i lettori concorrenti vanno sincronizzati)
+ */
+struct lru_eviction{};
+
+/**
+ * @brief Punto di personalizzazione per memory_usage: byte allocati sullo heap
+ * da un valore di tipo T, oltre a quelli occupati dal valore stesso nel nodo
+ * 
+ * Di default 0; va specializzato per i tipi che possiedono memoria dinamica
+ * 
+ * @tparam T tipo degli elementi
+ */
+template<typename T>
+struct heap_usage{
+    static std::size_t bytes(const T&){
+        return 0;
+    }
+};
+
+/**
+ * @brief Byte del buffer di una stringa (0 se la stringa è abbastanza corta
+ * da essere memorizzata nell'oggetto stesso)
+ */
+template<typename C, typename Tr, typename A>
+struct heap_usage<std::basic_string<C, Tr, A> >{
+    static std::size_t bytes(const std::basic_string<C, Tr, A> &s){
+        const char* data = reinterpret_cast<const char*>(s.data());
+        const char* self = reinterpret_cast<const char*>(&s);
+        if(data >= self && data < self + sizeof(s))
+            return 0;
+        return (s.capacity() + 1) * sizeof(C);
+    }
+};
+
+/**
+ * @brief Memoria occupata da un albero, ritornata da memory_usage()
+ */
+struct memory_stats{
+    std::size_t node_bytes;///< byte dei nodi (valori, puntatori e contatori)
+    std::size_t payload_bytes;///< byte allocati dai valori fuori dai nodi (vedi heap_usage)
+    std::size_t slack_bytes;///< byte persi dall'allocatore: arrotondamenti, intestazioni dei blocchi e spazi liberi nel blocco di compact()
+
+    memory_stats(): node_bytes(0), payload_bytes(0), slack_bytes(0){}
+
+    /**
+     * @brief Funzione che ritorna il totale dei byte occupati
+     * 
+     * @return std::size_t somma di nodi, valori e spreco dell'allocatore
+     */
+    std::size_t total() const{
+        return node_bytes + payload_bytes + slack_bytes;
+    }
+};
+
+/**
+ * @brief Nessuna verifica: i controlli degli invarianti non generano codice
+ */
+struct no_validation{};
+
+/**
+ * @brief Modalità di debug: dopo ogni modifica vengono verificati ordinamento,
+ * collegamenti parent, _size, minimo e massimo, e viene campionata la coerenza
+ * di Eql e Comp; le violazioni lanciano broken_invariant_exception.
+ * Il costo è lineare nel numero dei nodi per ogni modifica
+ */
+struct validate_invariants{};
+
+/**
+ * @brief Nessun aggregato: i nodi non memorizzano riepiloghi dei sotto-alberi
+ */
+struct no_aggregate{};
+
+/**
+ * @brief Aggregato somma, da usare come Policy::aggregate
+ * 
+ * Un aggregato è un monoide sui valori dell'albero: value_type è il tipo del
+ * riepilogo, identity() il suo elemento neutro, lift(value, copies) il riepilogo
+ * di un singolo nodo (copies è il numero di copie, sempre 1 con unique_keys) e
+ * combine(a, b) unisce i riepiloghi di due intervalli consecutivi. combine deve
+ * essere associativa ma non necessariamente commutativa
+ * 
+ * @tparam V tipo dei valori e della somma
+ */
+template<typename V>
+struct sum_aggregate{
+    typedef V value_type;
+
+    static V identity(){
+        return V();
+    }
+    static V lift(const V &value, std::size_t copies){
+        return value * static_cast<V>(copies);
+    }
+    static V combine(const V &a, const V &b){
+        return a + b;
+    }
+};
+
+/**
+ * @brief Aggregato minimo (vedi sum_aggregate)
+ * 
+ * @tparam V tipo dei valori
+ */
+template<typename V>
+struct min_aggregate{
+    typedef V value_type;
+
+    static V identity(){
+        return std::numeric_limits<V>::max();
+    }
+    static V lift(const V &value, std::size_t){
+        return value;
+    }
+    static V combine(const V &a, const V &b){
+        return b < a ? b : a;
+    }
+};
+
+/**
+ * @brief Aggregato massimo (vedi sum_aggregate)
+ * 
+ * @tparam V tipo dei valori
+ */
+template<typename V>
+struct max_aggregate{
+    typedef V value_type;
+
+    static V identity(){
+        return std::numeric_limits<V>::lowest();
+    }
+    static V lift(const V &value, std::size_t){
+        return value;
+    }
+    static V combine(const V &a, const V &b){
+        return a < b ? b : a;
+    }
+};
+
+/**
+ * @brief Politiche di default di binary_search_tree
+ * 
+ * Per cambiare una politica si deriva da questa struttura e si ridefinisce il
+ * typedef corrispondente, ad esempio
+ * struct multiset_policy : tree_policy { typedef multi_keys duplicates; };
+ */
+struct tree_policy{
+    typedef unique_keys duplicates;///< gestione dei valori duplicati
+    typedef static_access access;///< effetto delle ricerche sulla forma dell'albero
+    typedef no_aggregate aggregate;///< riepilogo dei sotto-alberi per aggregate(a, b)
+    typedef no_eviction eviction;///< scadenza dei valori e limite di capacità
+    typedef no_validation validation;///< verifiche dopo ogni modifica
+};
+
+/**
+ * @brief Politiche di default con verifica degli invarianti dopo ogni modifica
+ * 
+ * La modalità di debug si sceglie per tipo e non con una macro, così unità di
+ * traduzione compilate con opzioni diverse vedono la stessa definizione di tree_policy
+ */
+struct debug_policy : tree_policy{
+    typedef validate_invariants validation;
+};
+
+/**
+ * @brief Parte del nodo che memorizza il numero di copie del valore
+ * 
+ * In modalità unique_keys non occupa memoria e il numero di copie è sempre 1
+ * 
+ * @tparam Dup modalità di gestione dei duplicati
+ */
+template<typename Dup>
+struct node_count{
+    std::size_t count() const{
+        return 1;
+    }
+    void add_copies(std::size_t){}
+    void remove_copy(){}
+};
+
+template<>
+struct node_count<multi_keys>{
+    std::size_t copies = 1;///< numero di copie del valore
+
+    std::size_t count() const{
+        return copies;
+    }
+    void add_copies(std::size_t n){
+        copies += n;
+    }
+    void remove_copy(){
+        --copies;
+    }
+};
+
+/**
+ * @brief Parte del nodo che memorizza il riepilogo del proprio sotto-albero
+ * 
+ * Con no_aggregate non occupa memoria
+ * 
+ * @tparam Agg aggregato (vedi sum_aggregate)
+ */
+template<typename Agg>
+struct node_summary{
+    typename Agg::value_type summary;///< combinazione dei valori del sotto-albero, in ordine
+};
+
+template<>
+struct node_summary<no_aggregate>{};
+
+/**
+ * @brief Parte del nodo usata dalle politiche di eviction: lista intrusiva
+ * nell'ordine d'uso e istante di scadenza
+ * 
+ * Con no_eviction non occupa memoria
+ * 
+ * @tparam E politica di eviction
+ * @tparam Node tipo del nodo
+ */
+template<typename E, typename Node>
+struct node_expiry{
+    Node* older;///< nodo precedente nella lista d'uso
+    Node* newer;///< nodo successivo nella lista d'uso
+    std::chrono::steady_clock::time_point expires;///< istante di scadenza (time_point::max() se non scade)
+};
+
+template<typename Node>
+struct node_expiry<no_eviction, Node>{};
+
 /**
  * @brief Classe binary_search_tree
  * 
  * La classe implementa un generico albero binario di ricerca in cui ogni elemento
- * compare una e una sola volta
+ * compare una e una sola volta (o, con la politica multi_keys, con un contatore di copie)
  * 
  * @tparam T Tipo degli elementi contenuti della'albero 
  * @tparam Eql funtore di eguaglianza
  * @tparam Comp funtore di comparazione
+ * @tparam Policy politiche dell'albero (vedi tree_policy)
  */
-template<typename T, typename Eql, typename Comp> class binary_search_tree{
+template<typename T, typename Eql, typename Comp, typename Policy = tree_policy> class binary_search_tree{
+    typedef typename Policy::duplicates duplicates;
+    typedef typename Policy::access access;
+    typedef typename Policy::validation validation;
+    typedef typename Policy::aggregate aggregate_type;
+    typedef typename Policy::eviction eviction;
+    typedef std::chrono::steady_clock clock_type;
+
     /**
      * @brief Struttura nodo
      */
-    struct node{
+    struct node : node_count<duplicates>, node_summary<aggregate_type>, node_expiry<eviction, node>{
         T value;///< valore memorizzato
         node* parent;///< puntatore al nodo padre
         node* left;///< puntatore al nodo sinistro
@@ -59,16 +388,11 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
          * Copy constructor
          * @brief Costruisce un nodo a partire da un altro nodo copiando i dati membro a membro
          * 
+         * Generato dal compilatore: se T è banalmente copiabile lo è anche il nodo
+         * 
          * @param other oggetto nodo da copiare
          */
-        node(const node &other){
-            if (this != &other){
-                value = other.value;
-                parent = other.parent;
-                left = other.left;
-                right = other.left;
-            }
-        }
+        node(const node &other) = default;
 
         /**
          * Operatore assegnamento
@@ -77,26 +401,13 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
          * @param other nodo da copiare
          * @return reference del nodo this
          */
-        node& operator=(const node &other){
-            value = other.value;
-            parent = other.parent;
-            left = other.left;
-            right = other.left;
-            return *this;
-        }
+        node& operator=(const node &other) = default;
 
         /**
          * Distruttore
          * 
-         * @post parent == nullptr
-         * @post left == nullptr
-         * @post right == nullptr
          */
-        ~node(){
-            parent = nullptr;
-            left = nullptr;
-            right = nullptr;
-        } 
+        ~node() = default;
 
         /**
          * Funzione che implementa l'operatore di stream
@@ -111,81 +422,363 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
     
     };
    
-    node* _root;///< puntatore al radice dell'albero
-    unsigned int _size;///< numero di elementi salvati
+    template<typename K, typename V, typename E, typename C> friend class bst_map;
+
+    mutable node* _root;///< puntatore al radice dell'albero (mutable: con le politiche di accesso adattive anche le ricerche ristrutturano l'albero)
+    std::size_t _size;///< numero di nodi, cioè di valori distinti
+    std::size_t _total;///< numero dei valori contando ogni copia (uguale a _size in modalità unique_keys)
+    node* _min;///< puntatore al nodo con il valore più piccolo
+    node* _max;///< puntatore al nodo con il valore più grande
+    node* _arena;///< blocco contiguo in cui compact() ha ricollocato i nodi (nullptr se assente)
+    std::size_t _arena_size;///< numero di nodi che il blocco _arena può contenere
+    counting_bloom_filter<T>* _filter;///< filtro di appartenenza consultato da contains (nullptr se disattivato)
+    mutable node* _oldest;///< primo nodo della lista d'uso, il prossimo da rimuovere (solo con eviction)
+    mutable node* _newest;///< ultimo nodo della lista d'uso
+    mutable node* _sweep;///< prossimo nodo della lista d'uso controllato dalla pulizia incrementale (nullptr: si riparte da _oldest)
+    std::size_t _capacity;///< numero massimo di nodi (0 senza limite)
+    clock_type::duration _ttl;///< durata dei valori inseriti (zero se non scadono)
+    bool _timed;///< true se almeno un valore può scadere
     Eql _equals;///< funtore di uguaglianza tra due valori di tipo T
     Comp _compare;///< funtore di comparazione tra due valori di tipo T
 
+    /**
+     * @brief Tipo con cui i valori vengono passati lungo il cammino di ricerca:
+     * per valore se T è una chiave piccola, per reference costante altrimenti
+     */
+    typedef typename std::conditional<is_small_key<T>::value, T, const T&>::type key_arg;
+
+    /**
+     * @brief Confronto tra due valori quando Comp equivale a operator<
+     */
+    static bool less(key_arg a, key_arg b, std::true_type){
+        return a < b;
+    }
+
+    /**
+     * @brief Confronto tra due valori tramite il funtore Comp
+     */
+    bool less(key_arg a, key_arg b, std::false_type) const{
+        return _compare(a, b);
+    }
+
+    /**
+     * @brief Funzione che confronta due valori scegliendo a tempo di compilazione
+     * tra operator< e il funtore Comp
+     * 
+     * @param a primo valore
+     * @param b secondo valore
+     * @return true se a precede b
+     * @return false altrimenti
+     */
+    bool less(key_arg a, key_arg b) const{
+        return less(a, b, is_less_comparator<Comp, T>());
+    }
+
     
+    /**
+     * @brief Numero minimo di nodi per cui copia e costruzione bilanciata
+     * vengono divise tra più thread
+     */
+    static const std::size_t parallel_threshold = 1 << 16;
+
+    /**
+     * @brief Funzione che calcola quante volte copia e costruzione bilanciata
+     * possono dividersi su due thread
+     * 
+     * Ogni livello di divisione raddoppia i thread: il numero di livelli è scelto
+     * per avere circa il doppio dei core disponibili, così i sotto-alberi più
+     * piccoli non lasciano core inattivi
+     * 
+     * @param n numero dei nodi da creare
+     * @return unsigned int numero di livelli di divisione (0 per lavorare su un solo thread)
+     */
+    static unsigned int fork_depth(std::size_t n){
+        if(n < parallel_threshold)
+            return 0;
+        unsigned int cores = std::thread::hardware_concurrency();
+        unsigned int depth = 1;
+        while((1u << (depth - 1)) < cores)
+            ++depth;
+        return depth;
+    }
+
+    /**
+     * @brief Funzione che esegue left su un nuovo thread e right sul thread corrente
+     * e attende che terminino entrambe
+     * 
+     * Se il thread non può essere creato left viene eseguita sul thread corrente
+     * 
+     * @param left prima operazione
+     * @param right seconda operazione
+     * 
+     * @throw rilancia, dopo l'attesa, l'eccezione lanciata da left o da right
+     */
+    template<typename Left, typename Right>
+    static void fork_join(Left left, Right right){
+        std::exception_ptr left_error, right_error;
+        std::thread worker;
+        bool forked = false;
+        BST_TRY{
+            worker = std::thread([&left, &left_error](){
+                BST_TRY{
+                    left();
+                }BST_CATCH_ALL{
+                    left_error = std::current_exception();
+                }
+            });
+            forked = true;
+        }BST_CATCH_ALL{}
+
+        BST_TRY{
+            right();
+        }BST_CATCH_ALL{
+            right_error = std::current_exception();
+        }
+        if(forked)
+            worker.join();
+        else
+            left();
+        if(left_error)
+            std::rethrow_exception(left_error);
+        if(right_error)
+            std::rethrow_exception(right_error);
+    }
+
     /**
      * @brief Funzione che copia un albero a partire da un nodo passato in input
      * 
+     * Finché forks è positivo e entrambi i sotto-alberi di un nodo hanno almeno
+     * fork_threshold nodi, i due sotto-alberi vengono copiati in parallelo; il resto
+     * viene copiato da copy_sequential, che non usa la ricorsione, così anche gli
+     * alberi degeneri in una catena non esauriscono lo stack. Se un'allocazione
+     * fallisce i nodi già copiati vengono rimossi
+     * 
      * @param root radice dell'albero 
      * @param parent nodo padre del nodo root
+     * @param forks livelli di divisione su più thread ancora disponibili (vedi fork_depth)
      * @return node* puntatore al nuovo albero copiato
+     * 
+     * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
      */
-    node* copy(const node* const root, node *const parent = nullptr) const{
+    node* copy(const node* const root, node *const parent = nullptr, unsigned int forks = 0) const{
         if(root == nullptr)
             return nullptr;
-        
-        node* clone = new node(root->value);
+        if(forks == 0 || count_node(root->left, fork_threshold) < fork_threshold
+                      || count_node(root->right, fork_threshold) < fork_threshold)
+            return copy_sequential(root, parent);
+
+        node* clone = clone_node(root, parent);
+        BST_TRY{
+            fork_join([&](){ clone->left = copy(root->left, clone, forks - 1); },
+                      [&](){ clone->right = copy(root->right, clone, forks - 1); });
+        }BST_CATCH_ALL{
+            destroy_subtree(clone);
+            BST_RETHROW;
+        }
+        return clone;
+    }
+
+    /**
+     * @brief Numero minimo di nodi di ciascuno dei due sotto-alberi perché copy
+     * li copi su due thread
+     */
+    static const std::size_t fork_threshold = parallel_threshold / 4;
+
+    /**
+     * @brief Funzione che copia un nodo senza i collegamenti ai figli
+     * 
+     * @param source nodo da copiare
+     * @param parent padre della copia
+     * @return node* copia del nodo
+     * 
+     * @throw std::bad_alloc eccezione durante l'allocazione del nodo
+     */
+    static node* clone_node(const node *source, node *parent){
+        node* clone = new node(*source);
         clone->parent = parent;
-        clone->left = copy(root->left, clone);
-        clone->right = copy(root->right, clone);
+        clone->left = clone->right = nullptr;
         return clone;
     }
 
+    /**
+     * @brief Funzione che copia un sotto-albero su un solo thread
+     * 
+     * La visita in pre-ordine è iterativa: scende nell'originale e nella copia
+     * insieme e risale tramite parent, quindi lo stack usato non dipende
+     * dall'altezza dell'albero. Un figlio della copia ancora nullptr indica
+     * un sotto-albero ancora da copiare
+     * 
+     * @param root radice del sotto-albero da copiare
+     * @param parent nodo padre della copia di root
+     * @return node* radice della copia
+     * 
+     * @throw std::bad_alloc eccezione durante l'allocazione di un nodo (i nodi già copiati vengono rimossi)
+     */
+    node* copy_sequential(const node *root, node *parent) const{
+        node* top = clone_node(root, parent);
+        BST_TRY{
+            const node* s = root;
+            node* c = top;
+            while(true){
+                if(s->left != nullptr && c->left == nullptr){
+                    c->left = clone_node(s->left, c);
+                    s = s->left;
+                    c = c->left;
+                }else if(s->right != nullptr && c->right == nullptr){
+                    c->right = clone_node(s->right, c);
+                    s = s->right;
+                    c = c->right;
+                }else if(s != root){
+                    s = s->parent;
+                    c = c->parent;
+                }else{
+                    break;
+                }
+            }
+        }BST_CATCH_ALL{
+            destroy_subtree(top);
+            BST_RETHROW;
+        }
+        return top;
+    }
+
     /**
      * @brief Funzione che calcola il numero dei nodi di un albero binario di ricerca
      * a partire dal nodo radice
      * 
+     * La visita è iterativa (risale tramite parent) e si ferma appena raggiunge
+     * limit nodi, così può anche verificare in tempo limitato se un sotto-albero
+     * è abbastanza grande
+     * 
      * @param root radice dell'albero binario di ricerca
-     * @return unsigned int numero dei nodi
+     * @param limit numero di nodi oltre il quale il conteggio si ferma
+     * @return std::size_t numero dei nodi (al più limit)
      */
-    unsigned int count_node(const node* const root) const{
+    std::size_t count_node(const node* const root, std::size_t limit = std::numeric_limits<std::size_t>::max()) const{
         if(root == nullptr)
             return 0;
-        return count_node(root->left) + count_node(root->right) + 1;
+        std::size_t counted = 0;
+        const node* x = root;
+        while(x->left != nullptr)
+            x = x->left;
+        while(x != nullptr && counted < limit){
+            ++counted;
+            if(x->right != nullptr){
+                x = x->right;
+                while(x->left != nullptr)
+                    x = x->left;
+            }else{
+                while(x != root && x == x->parent->right)
+                    x = x->parent;
+                x = x == root ? nullptr : x->parent;
+            }
+        }
+        return counted;
     }
 
     /**
-     * @brief Funzione che rimuove i nodi di un albero binario di ricerca a partire
-     * dalla radice
+     * @brief Funzione che verifica se un nodo si trova nel blocco contiguo creato da compact()
      * 
-     * @param node nodo radice
+     * @param n nodo da verificare
+     * @return true se il nodo si trova in _arena
+     * @return false se il nodo è stato allocato singolarmente
      */
-    void erase(const node* node){ 
-        if(node == nullptr)
-            return;
+    bool in_arena(const node *n) const{
+        std::less<const node*> before;
+        return _arena != nullptr && !before(n, _arena) && before(n, _arena + _arena_size);
+    }
 
-        erase(node->left);
-        erase(node->right);
-        delete node;
-        _size--;
-        node = nullptr;
+    /**
+     * @brief Funzione che stima i byte persi dall'allocatore per un blocco
+     * 
+     * Con la glibc sono l'arrotondamento ritornato da malloc_usable_size più
+     * l'intestazione del blocco; con altre librerie la stima è 0
+     * 
+     * @param p blocco allocato con operator new
+     * @param requested byte richiesti
+     * @return std::size_t byte allocati oltre a quelli richiesti
+     */
+    static std::size_t allocation_slack(const void *p, std::size_t requested){
+#if defined(__GLIBC__)
+        return malloc_usable_size(const_cast<void*>(p)) - requested + sizeof(std::size_t);
+#else
+        (void)p;
+        (void)requested;
+        return 0;
+#endif
     }
 
     /**
-     * @brief Funzione che verifica se un valore è contenuto nell'abero binario di ricerca
-     * passanto come paramentro
+     * @brief Funzione che distrugge un nodo: i nodi allocati singolarmente vengono
+     * deallocati, quelli nel blocco di compact() vengono solo distrutti (lo spazio
+     * viene liberato insieme al blocco)
      * 
-     * @param root radice dell'albero binario di ricerca
-     * @param value valore da cercare
-     * @return true se il valore è presente
-     * @return false se il valore non è presente
+     * @param n nodo da distruggere
+     */
+    void destroy_node(node *n) const{
+        if(in_arena(n))
+            n->~node();
+        else
+            delete n;
+    }
+
+    /**
+     * @brief Funzione che libera il blocco contiguo creato da compact()
+     * 
+     * @pre nessun nodo vivo si trova nel blocco
+     */
+    void release_arena(){
+        ::operator delete(_arena);
+        _arena = nullptr;
+        _arena_size = 0;
+    }
+
+    /**
+     * @brief Funzione che distrugge i nodi di un sotto-albero a partire dalla radice
+     * 
+     * La visita è iterativa (risale tramite parent), così anche alberi molto
+     * sbilanciati, come quelli prodotti da inserimenti ordinati, non esauriscono lo stack.
+     * Il padre di root non viene modificato e _size non viene aggiornato, quindi
+     * più thread possono distruggere sotto-alberi distinti
+     * 
+     * @param root nodo radice
+     * @return std::size_t numero dei nodi distrutti
      */
-    bool contains_value(const node* const root, const T &value) const{
+    std::size_t destroy_subtree(node* root) const{
         if(root == nullptr)
-            return false;
+            return 0;
 
-        if(_equals(root->value, value))
-            return true;
-        else{
-            if(_compare(value, root->value))
-                return contains_value(root->left, value);
-            else
-                return contains_value(root->right, value);
+        std::size_t destroyed = 0;
+        node* const stop = root->parent;
+        while(root != stop){
+            if(root->left != nullptr){
+                root = root->left;
+            }else if(root->right != nullptr){
+                root = root->right;
+            }else{
+                node* p = root->parent;
+                if(p != stop){
+                    if(p->left == root)
+                        p->left = nullptr;
+                    else
+                        p->right = nullptr;
+                }
+                destroy_node(root);
+                ++destroyed;
+                root = p;
+            }
         }
+        return destroyed;
+    }
+
+    /**
+     * @brief Funzione che rimuove i nodi di un albero binario di ricerca a partire
+     * dalla radice
+     * 
+     * @param root nodo radice
+     */
+    void erase(node* root){ 
+        _size -= destroy_subtree(root);
     }
 
     /**
@@ -193,195 +786,2022 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
      * ritorna il puntatore al nodo in cui è memorizzato il valore 
      * 
      * @param root radice dell'albero binario di ricerca
-     * @param value valore da cerca
-     * @return const node* const puntatore al nodo in cui value è memorizzato
+     * @param value valore da cercare
+     * @return const node* puntatore al nodo in cui value è memorizzato (nullptr se non presente)
      */
-    const node* const get_node(const node* const root, const T &value) const{
-        if(root == nullptr)
-            return root;
-        if(_equals(value, root->value))
-            return root;
-        else{
-            if(_compare(value, root->value))
-                return get_node(root->left, value);
-            else
-                return get_node(root->right, value);
+    const node* find_node(const node* root, key_arg value) const{
+        while(root != nullptr && !_equals(root->value, value))
+            root = less(value, root->value) ? root->left : root->right;
+        return root;
+    }
+
+    /**
+     * @brief Funzione che ritorna il puntatore al nodo che contiene il valore
+     * più piccolo presente nell'albero binario di ricerca passato come paramento
+     * 
+     * @param root radice dell'albero binario di ricerca
+     * @return const node* const puntatore al nodo in cui è presente il valore più piccolo
+     */
+    const node* const min_value_node(const node* root) const{
+        if(root == nullptr)
+            return root;
+        while(root->left != nullptr)
+            root = root->left;
+        return root;
+    }
+
+
+    /**
+     * @brief Funzione che fa salire un nodo al posto del padre con una rotazione
+     * 
+     * L'ordine dei valori non cambia e nessun nodo viene spostato in memoria,
+     * quindi gli iteratori restano validi
+     * 
+     * @param x nodo da far salire (deve avere un padre)
+     */
+    void rotate_up(node *x) const{
+        node* p = x->parent;
+        node* g = p->parent;
+        if(x == p->left){
+            p->left = x->right;
+            if(x->right != nullptr)
+                x->right->parent = p;
+            x->right = p;
+        }else{
+            p->right = x->left;
+            if(x->left != nullptr)
+                x->left->parent = p;
+            x->left = p;
+        }
+        p->parent = x;
+        x->parent = g;
+        if(g == nullptr)
+            _root = x;
+        else if(g->left == p)
+            g->left = x;
+        else
+            g->right = x;
+        pull(p);
+        pull(x);
+    }
+
+    /**
+     * @brief Funzione che ricalcola il riepilogo di un nodo dai riepiloghi dei figli
+     * 
+     * @param n nodo da aggiornare
+     */
+    void pull(node *n) const{
+        pull(n, aggregate_type());
+    }
+
+    /**
+     * @brief Nessun riepilogo da aggiornare
+     */
+    void pull(node*, no_aggregate) const{}
+
+    /**
+     * @brief Ricalcola il riepilogo del nodo: sinistro, nodo, destro
+     */
+    template<typename Agg>
+    void pull(node *n, Agg) const{
+        typename Agg::value_type s = Agg::lift(n->value, n->count());
+        if(n->left != nullptr)
+            s = Agg::combine(n->left->summary, s);
+        if(n->right != nullptr)
+            s = Agg::combine(s, n->right->summary);
+        n->summary = s;
+    }
+
+    /**
+     * @brief Funzione che ricalcola i riepiloghi da un nodo fino alla radice,
+     * dopo che il suo sotto-albero o il suo contatore di copie è cambiato
+     * 
+     * @param n primo nodo da aggiornare (può essere nullptr)
+     */
+    void pull_path(node *n) const{
+        if(std::is_same<aggregate_type, no_aggregate>::value)
+            return;
+        for(; n != nullptr; n = n->parent)
+            pull(n);
+    }
+
+    /**
+     * @brief Funzione che calcola i riepiloghi di tutti i nodi di un sotto-albero
+     * 
+     * @param root radice del sotto-albero
+     */
+    void pull_subtree(node *root) const{
+        if(std::is_same<aggregate_type, no_aggregate>::value || root == nullptr)
+            return;
+        // visita in post-ordine iterativa: prev distingue se si arriva dal padre,
+        // dal figlio sinistro o dal figlio destro
+        node* const stop = root->parent;
+        node* prev = stop;
+        node* x = root;
+        while(x != stop){
+            node* next = x->parent;
+            if(prev == x->parent && x->left != nullptr)
+                next = x->left;
+            else if(prev != x->right && x->right != nullptr)
+                next = x->right;
+            else
+                pull(x);
+            prev = x;
+            x = next;
+        }
+    }
+
+    /**
+     * @brief Numero massimo di nodi scaduti rimossi da ogni inserimento: il costo
+     * della pulizia resta costante e non serve una ricostruzione dell'albero
+     */
+    static const unsigned int sweep_batch = 4;
+
+    /**
+     * @brief Funzione che aggiunge un nodo in fondo alla lista d'uso
+     *
+     * @param n nodo non presente nella lista
+     */
+    void append_use(node *n) const{
+        n->older = _newest;
+        n->newer = nullptr;
+        if(_newest != nullptr)
+            _newest->newer = n;
+        else
+            _oldest = n;
+        _newest = n;
+    }
+
+    /**
+     * @brief Funzione che stacca un nodo dalla lista d'uso
+     *
+     * @param n nodo presente nella lista
+     */
+    void detach_use(node *n) const{
+        if(_sweep == n)
+            _sweep = n->newer;
+        if(n->older != nullptr)
+            n->older->newer = n->newer;
+        else
+            _oldest = n->newer;
+        if(n->newer != nullptr)
+            n->newer->older = n->older;
+        else
+            _newest = n->older;
+    }
+
+    /**
+     * @brief Nodo appena inserito con politica no_eviction: nessun effetto
+     */
+    void track(node*, no_eviction){}
+
+    /**
+     * @brief Nodo appena inserito: va in fondo alla lista d'uso con la durata scelta in set_ttl
+     */
+    template<typename E>
+    void track(node *n, E){
+        n->expires = _ttl == clock_type::duration::zero() ? clock_type::time_point::max() : clock_type::now() + _ttl;
+        append_use(n);
+    }
+
+    /**
+     * @brief Nodo rimosso con politica no_eviction: nessun effetto
+     */
+    void untrack(node*, no_eviction){}
+
+    /**
+     * @brief Nodo rimosso: esce dalla lista d'uso
+     */
+    template<typename E>
+    void untrack(node *n, E){
+        detach_use(n);
+    }
+
+    /**
+     * @brief Ricerca andata a buon fine con politica lru_eviction: il nodo diventa il più recente
+     */
+    void touch(const node *n, lru_eviction) const{
+        node* m = const_cast<node*>(n);
+        if(m != _newest){
+            detach_use(m);
+            append_use(m);
+        }
+    }
+
+    /**
+     * @brief Ricerca andata a buon fine con le altre politiche: l'ordine della lista non cambia
+     */
+    template<typename E>
+    void touch(const node*, E) const{}
+
+    /**
+     * @brief Con politica no_eviction nessun valore scade
+     */
+    bool expired(const node*, no_eviction) const{
+        return false;
+    }
+
+    /**
+     * @brief Funzione che verifica se il valore di un nodo è scaduto
+     */
+    template<typename E>
+    bool expired(const node *n, E) const{
+        return _timed && n->expires <= clock_type::now();
+    }
+
+    /**
+     * @brief Funzione che filtra il risultato di una ricerca: un valore scaduto e
+     * non ancora rimosso risulta assente, uno valido viene segnato come usato
+     *
+     * @param n nodo trovato (può essere nullptr)
+     * @return const node* n, oppure nullptr se il valore è scaduto
+     */
+    const node* live(const node *n) const{
+        if(n == nullptr || expired(n, eviction()))
+            return nullptr;
+        touch(n, eviction());
+        return n;
+    }
+
+    /**
+     * @brief Con politica no_eviction nessun nodo scade
+     */
+    void revive(node*, no_eviction){}
+
+    /**
+     * @brief Funzione che riporta in vita un nodo scaduto a cui viene aggiunto di
+     * nuovo il valore: una sola copia, nuova scadenza e posizione più recente
+     *
+     * @param n nodo scaduto
+     */
+    template<typename E>
+    void revive(node *n, E){
+        _total -= n->count() - 1;
+        while(n->count() > 1)
+            n->remove_copy();
+        detach_use(n);
+        track(n, eviction());
+        pull_path(n);
+    }
+
+    /**
+     * @brief Compattazione con politica no_eviction: nessuna lista da aggiornare
+     */
+    void relink_uses(node&, no_eviction){}
+
+    /**
+     * @brief Compattazione: i collegamenti della lista d'uso passano alle copie dei
+     * nodi, raggiungibili tramite il parent dei nodi originali
+     */
+    template<typename E>
+    void relink_uses(node &c, E){
+        if(c.older != nullptr)
+            c.older = c.older->parent;
+        if(c.newer != nullptr)
+            c.newer = c.newer->parent;
+    }
+
+    /**
+     * @brief Copia con politica no_eviction: nessuna lista da ricostruire
+     */
+    void copy_uses(const binary_search_tree&, const node*, no_eviction){}
+
+    /**
+     * @brief Funzione che ricostruisce la lista d'uso di una copia seguendo l'ordine
+     * della lista dell'originale; i valori che la copia non contiene vengono saltati
+     *
+     * Il nodo copiato corrispondente a ogni nodo dell'originale si trova con una
+     * ricerca binaria tra gli indirizzi, non con una ricerca nell'albero: il costo
+     * non dipende dall'altezza, quindi resta O(n log n) anche per alberi degeneri
+     *
+     * @param other albero copiato
+     * @param source radice del sotto-albero di other da cui è stata fatta la copia
+     */
+    template<typename E>
+    void copy_uses(const binary_search_tree &other, const node *source, E){
+        // coppie (originale, copia) raccolte visitando in ordine i due alberi,
+        // che hanno la stessa forma, e ordinate per indirizzo dell'originale
+        typedef std::pair<const node*, node*> copied;
+        std::vector<copied> pairs;
+        pairs.reserve(_size);
+        const node* s = source == nullptr ? nullptr : min_value_node(source);
+        for(node* c = _min; c != nullptr; c = const_cast<node*>(successor(c)), s = successor(s))
+            pairs.push_back(copied(s, c));
+        std::less<const node*> before;
+        std::sort(pairs.begin(), pairs.end(), [&before](const copied &a, const copied &b){ return before(a.first, b.first); });
+        for(const node* n = other._oldest; n != nullptr; n = n->newer){
+            typename std::vector<copied>::iterator it = std::lower_bound(pairs.begin(), pairs.end(), copied(n, nullptr),
+                [&before](const copied &a, const copied &b){ return before(a.first, b.first); });
+            if(it != pairs.end() && it->first == n){
+                it->second->expires = n->expires;
+                append_use(it->second);
+            }
+        }
+    }
+
+    /**
+     * @brief Pulizia incrementale con politica no_eviction: nessun effetto
+     */
+    void evict(const node*, no_eviction){}
+
+    /**
+     * @brief Funzione chiamata dopo ogni inserimento: rimuove al più sweep_batch
+     * nodi scaduti dall'inizio della lista, ne controlla altri sweep_batch a
+     * partire da _sweep e poi rimuove i nodi più vecchi finché il numero dei
+     * valori supera la capacità
+     *
+     * La lista è in ordine di inserimento, quindi con una durata unica i nodi
+     * scaduti sono all'inizio; le scadenze impostate con expire_at possono stare
+     * in qualsiasi punto e vengono raggiunte da _sweep, che percorre la lista
+     * un passo per volta e ricomincia dall'inizio quando arriva in fondo
+     *
+     * @param keep nodo appena inserito, che non viene rimosso
+     */
+    template<typename E>
+    void evict(const node *keep, E){
+        if(_timed){
+            clock_type::time_point now = clock_type::now();
+            for(unsigned int k = 0; k < sweep_batch && _oldest != keep && _oldest->expires <= now; ++k)
+                unlink(_oldest);
+            for(unsigned int k = 0; k < sweep_batch && _oldest != nullptr; ++k){
+                node* n = _sweep != nullptr ? _sweep : _oldest;
+                _sweep = n->newer;
+                if(n != keep && n->expires <= now)
+                    unlink(n);
+            }
+        }
+        if(_capacity != 0)
+            while(_total > _capacity && evict_copy(keep)){}
+    }
+
+    /**
+     * @brief Funzione che rimuove una copia del valore più vecchio della lista
+     * d'uso (il nodo quando resta l'ultima copia)
+     *
+     * Il nodo keep perde solo le copie in più, così il valore appena inserito resta
+     *
+     * @param keep nodo da non rimuovere (nullptr se nessuno)
+     * @return true se una copia è stata rimossa
+     * @return false se non c'era niente da rimuovere
+     */
+    bool evict_copy(const node *keep){
+        node* victim = _oldest;
+        if(victim == keep && victim != nullptr && victim->count() == 1)
+            victim = victim->newer;
+        if(victim == nullptr)
+            return false;
+        remove_copy(victim);
+        return true;
+    }
+
+    /**
+     * @brief Funzione che rimuove un nodo trovato da una ricerca se il suo valore
+     * è scaduto
+     *
+     * @param n nodo trovato (può essere nullptr)
+     * @return node* n, oppure nullptr se il nodo è stato rimosso
+     */
+    node* purge_expired(node *n){
+        if(n != nullptr && expired(n, eviction())){
+            unlink(n);
+            check_invariants();
+            return nullptr;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Funzione che salta i valori scaduti a partire da un nodo, nell'ordine
+     * dei valori
+     *
+     * @param n primo nodo da considerare (può essere nullptr)
+     * @return const node* primo nodo non scaduto da n in poi (nullptr se nessuno)
+     */
+    const node* skip_expired(const node *n) const{
+        while(n != nullptr && expired(n, eviction()))
+            n = successor(n);
+        return n;
+    }
+
+    /**
+     * @brief Verifica della lista d'uso con politica no_eviction: nessuna lista
+     */
+    void check_uses(no_eviction) const{}
+
+    /**
+     * @brief Verifica che la lista d'uso contenga ogni nodo una volta sola e che
+     * i collegamenti nei due versi siano coerenti
+     *
+     * @throw broken_invariant_exception eccezione lanciata se la lista non è coerente
+     */
+    template<typename E>
+    void check_uses(E) const{
+        std::size_t length = 0;
+        const node* prev = nullptr;
+        for(const node* n = _oldest; n != nullptr; prev = n, n = n->newer){
+            if(n->older != prev)
+                BST_THROW(broken_invariant_exception("The use list is not doubly linked"));
+            if(++length > _size)
+                BST_THROW(broken_invariant_exception("The use list has more nodes than _size"));
+        }
+        if(length != _size || prev != _newest)
+            BST_THROW(broken_invariant_exception("The use list does not hold every node"));
+    }
+
+    /**
+     * @brief Funzione che porta un nodo nella radice con le rotazioni zig, zig-zig e zig-zag
+     * 
+     * @param x nodo da portare nella radice
+     */
+    void splay(node *x) const{
+        while(x->parent != nullptr){
+            node* p = x->parent;
+            node* g = p->parent;
+            if(g == nullptr){
+                rotate_up(x);
+            }else if((x == p->left) == (p == g->left)){
+                rotate_up(p);
+                rotate_up(x);
+            }else{
+                rotate_up(x);
+                rotate_up(x);
+            }
+        }
+    }
+
+    /**
+     * @brief Funzione hash usata dal filtro: chiama il funtore Hash scelto in enable_filter
+     */
+    template<typename Hash>
+    static std::size_t hash_thunk(const T &value){
+        return Hash()(value);
+    }
+
+    /**
+     * @brief Funzione che ricrea il filtro con tutti i valori dell'albero
+     * 
+     * @param capacity numero di valori per cui dimensionare il nuovo filtro
+     * @param fp_rate probabilità di falso positivo
+     * @param hash funzione hash
+     * 
+     * @throw std::bad_alloc eccezione durante l'allocazione dei contatori (il filtro precedente resta in uso)
+     */
+    void rebuild_filter(std::size_t capacity, double fp_rate, typename counting_bloom_filter<T>::hash_function hash){
+        counting_bloom_filter<T>* rebuilt = new counting_bloom_filter<T>(capacity, fp_rate, hash);
+        for(const node* n = _min; n != nullptr; n = successor(n))
+            rebuilt->insert(n->value);
+        delete _filter;
+        _filter = rebuilt;
+    }
+
+    /**
+     * @brief Funzione che aggiunge un valore al filtro; quando i valori superano la
+     * capacità il filtro viene ridimensionato al doppio per mantenere la
+     * probabilità di falso positivo richiesta
+     * 
+     * @param value valore appena inserito nell'albero
+     */
+    void filter_insert(const T &value){
+        _filter->insert(value);
+        if(_size > _filter->capacity()){
+            BST_TRY{
+                rebuild_filter(2 * _size, _filter->false_positive_rate(), _filter->hash());
+            }BST_CATCH_ALL{} // senza memoria si continua con il filtro attuale, meno preciso
+        }
+    }
+
+    /**
+     * @brief Funzione che verifica gli invarianti dell'albero secondo la politica validation
+     * 
+     * @throw broken_invariant_exception eccezione lanciata se un invariante è violato (solo validate_invariants)
+     */
+    void check_invariants() const{
+        check_invariants(validation());
+    }
+
+    /**
+     * @brief Nessuna verifica
+     */
+    void check_invariants(no_validation) const{}
+
+    /**
+     * @brief Verifica di debug: visita tutti i nodi e campiona coppie di valori
+     * 
+     * Per ogni coppia a, b con a che precede b nella visita in ordine devono valere
+     * Comp(a, b), !Comp(b, a) e !Eql(a, b): una coppia di valori non confrontabili
+     * (come con un ordinamento parziale) o un Eql in disaccordo con Comp viene
+     * segnalata anche se nessuna ricerca l'ha ancora incontrata
+     * 
+     * @throw broken_invariant_exception eccezione lanciata se un invariante è violato
+     */
+    void check_invariants(validate_invariants) const{
+        check_uses(eviction());
+        if(_root == nullptr){
+            if(_size != 0 || _total != 0 || _min != nullptr || _max != nullptr)
+                BST_THROW(broken_invariant_exception("Empty tree with a nonzero size or cached bounds"));
+            return;
+        }
+        if(_root->parent != nullptr)
+            BST_THROW(broken_invariant_exception("The root has a parent"));
+
+        std::vector<const node*> order;
+        std::vector<const node*> stack;
+        std::size_t copies = 0;
+        order.reserve(_size);
+        const node* n = _root;
+        while(n != nullptr || !stack.empty()){
+            for(; n != nullptr; n = n->left){
+                if((n->left != nullptr && n->left->parent != n) || (n->right != nullptr && n->right->parent != n))
+                    BST_THROW(broken_invariant_exception("A child does not point back to its parent"));
+                if(n->count() == 0)
+                    BST_THROW(broken_invariant_exception("A node stores zero copies"));
+                stack.push_back(n);
+            }
+            n = stack.back();
+            stack.pop_back();
+            order.push_back(n);
+            copies += n->count();
+            if(order.size() > _size)
+                BST_THROW(broken_invariant_exception("The tree has more nodes than _size"));
+            n = n->right;
+        }
+        if(order.size() != _size)
+            BST_THROW(broken_invariant_exception("The tree has fewer nodes than _size"));
+        if(copies != _total)
+            BST_THROW(broken_invariant_exception("_total differs from the number of copies"));
+        if(order.front() != _min || order.back() != _max)
+            BST_THROW(broken_invariant_exception("Cached minimum or maximum is stale"));
+        for(std::size_t i = 1; i < order.size(); ++i)
+            if(!_compare(order[i - 1]->value, order[i]->value))
+                BST_THROW(broken_invariant_exception("In-order values are not strictly increasing"));
+
+        const std::size_t samples = 64;
+        const std::size_t size = order.size();
+        if(size * (size - 1) / 2 <= samples){
+            for(std::size_t i = 0; i < size; ++i)
+                for(std::size_t j = i + 1; j < size; ++j)
+                    check_pair(order[i]->value, order[j]->value);
+        }else{
+            for(std::size_t k = 0; k < samples; ++k){
+                std::size_t i = (k * 2654435761u + size) % size;
+                std::size_t j = (k * 40503u + 7 * size + 1) % size;
+                if(i != j)
+                    check_pair(order[std::min(i, j)]->value, order[std::max(i, j)]->value);
+            }
+        }
+    }
+
+    /**
+     * @brief Verifica la coerenza di Eql e Comp su due valori
+     * 
+     * @param a valore che precede b nella visita in ordine
+     * @param b valore che segue a nella visita in ordine
+     * 
+     * @throw broken_invariant_exception eccezione lanciata se i funtori non sono coerenti
+     */
+    void check_pair(const T &a, const T &b) const{
+        if(_compare(a, a) || !_equals(a, a))
+            BST_THROW(broken_invariant_exception("Comp is not irreflexive or Eql is not reflexive"));
+        if(!_compare(a, b) || _compare(b, a))
+            BST_THROW(broken_invariant_exception("Comp is not a strict weak ordering: values are incomparable or inconsistent"));
+        if(_equals(a, b))
+            BST_THROW(broken_invariant_exception("Eql disagrees with Comp"));
+    }
+
+    /**
+     * @brief Accesso a un nodo con politica static_access: nessun effetto
+     */
+    void on_access(const node*, static_access) const{}
+
+    /**
+     * @brief Accesso a un nodo con politica splay_access: il nodo diventa la radice
+     */
+    void on_access(const node *n, splay_access) const{
+        splay(const_cast<node*>(n));
+        check_invariants();
+    }
+
+    /**
+     * @brief Accesso a un nodo con politica transpose_access: il nodo sale di un livello
+     */
+    void on_access(const node *n, transpose_access) const{
+        if(n->parent != nullptr)
+            rotate_up(const_cast<node*>(n));
+        check_invariants();
+    }
+
+    /**
+     * @brief Funzione che cerca un valore e applica al nodo trovato la politica di accesso
+     * 
+     * @param value valore da cercare
+     * @return const node* nodo che contiene il valore (nullptr se non presente)
+     */
+    const node* access_node(const T &value) const{
+        const node* n = live(find_node(_root, value));
+        if(n != nullptr)
+            on_access(n, access());
+        return n;
+    }
+
+    /**
+     * @brief Funzione che ritorna il nodo successivo nell'ordine dei valori
+     * 
+     * @param ptr puntatore al nodo
+     * @return const node* nodo successivo (nullptr se ptr è l'ultimo)
+     */
+    static const node* successor(const node* ptr){
+        if(ptr == nullptr)
+            return ptr;
+        if(ptr->right != nullptr){
+            ptr = ptr->right; // successore di ptr è il minimo del sotto albero destro
+            while(ptr->left != nullptr)
+                ptr = ptr->left;
+            return ptr;
+        }
+        while (ptr->parent != nullptr && ptr == ptr->parent->right)//risale l'albero
+            ptr = ptr->parent;
+        return ptr->parent;
+    }
+
+    /**
+     * @brief Funzione che ritorna il nodo precedente nell'ordine dei valori
+     * 
+     * @param ptr puntatore al nodo
+     * @return const node* nodo precedente (nullptr se ptr è il primo)
+     */
+    static const node* predecessor(const node* ptr){
+        if(ptr == nullptr)
+            return ptr;
+        if(ptr->left != nullptr){
+            ptr = ptr->left;
+            while(ptr->right != nullptr)
+                ptr = ptr->right;
+            return ptr;
+        }
+        while(ptr->parent != nullptr && ptr == ptr->parent->left)
+            ptr = ptr->parent;
+        return ptr->parent;
+    }
+
+    /**
+     * @brief Funzione che ricalcola i puntatori al nodo minimo e al nodo massimo
+     * dopo una modifica di più nodi
+     * 
+     * @post _min == nodo più a sinistra, _max == nodo più a destra (nullptr se l'albero è vuoto)
+     */
+    void reset_bounds(){
+        _min = _max = _root;
+        if(_root == nullptr)
+            return;
+        while(_min->left != nullptr)
+            _min = _min->left;
+        while(_max->right != nullptr)
+            _max = _max->right;
+    }
+
+    /**
+     * @brief Funzione che costruisce un albero bilanciato a partire da un array ordinato
+     * di valori distinti
+     * 
+     * Finché forks è positivo e l'intervallo è abbastanza grande le due metà
+     * vengono costruite in parallelo. _size non viene aggiornato: è compito del chiamante
+     * 
+     * @param values array ordinato dei valori
+     * @param lo indice del primo valore da inserire
+     * @param hi indice successivo all'ultimo valore da inserire
+     * @param parent nodo padre della radice del nuovo albero
+     * @param forks livelli di divisione su più thread ancora disponibili (vedi fork_depth)
+     * @return node* puntatore alla radice del nuovo albero
+     * 
+     * @throw std::bad_alloc eccezione durante l'allocazione di un nodo (i nodi già creati vengono rimossi)
+     */
+    node* build_balanced(const T *values, std::size_t lo, std::size_t hi, node *const parent = nullptr, unsigned int forks = 0){
+        if(lo >= hi)
+            return nullptr;
+
+        std::size_t mid = lo + (hi - lo) / 2;
+        node* root = new node(values[mid], parent);
+        BST_TRY{
+            if(forks > 0 && hi - lo >= parallel_threshold){
+                fork_join([&](){ root->left = build_balanced(values, lo, mid, root, forks - 1); },
+                          [&](){ root->right = build_balanced(values, mid + 1, hi, root, forks - 1); });
+            }else{
+                root->left = build_balanced(values, lo, mid, root);
+                root->right = build_balanced(values, mid + 1, hi, root);
+            }
+        }BST_CATCH_ALL{
+            destroy_subtree(root);
+            BST_RETHROW;
+        }
+        return root;
+    }
+
+    /**
+     * @brief Funzione che, a partire da un nodo vicino (finger), risale l'albero
+     * tramite parent fino al primo nodo il cui sotto-albero può contenere il valore
+     * 
+     * Il costo è proporzionale alla distanza tra il valore e il nodo di partenza
+     * invece che all'altezza dell'albero
+     * 
+     * @param from nodo da cui partire
+     * @param value valore da cercare o inserire
+     * @return node* nodo da cui iniziare la discesa
+     */
+    node* finger_start(node *from, const T &value) const{
+        bool greater = !less(value, from->value);
+        if(greater && !less(value, _max->value))
+            return _max;
+        if(!greater && !less(_min->value, value))
+            return _min;
+
+        node* x = from;
+        while(x->parent != nullptr){
+            node* p = x->parent;
+            if(greater){
+                if(x == p->left && less(value, p->value))
+                    break;
+            }else{
+                if(x == p->right && less(p->value, value))
+                    break;
+            }
+            x = p;
+        }
+        return x;
+    }
+
+    /**
+     * @brief Funzione che ritorna il nodo da cui iniziare una ricerca guidata da un iteratore
+     * 
+     * @param hint iteratore a un nodo vicino al valore
+     * @param value valore da cercare o inserire
+     * @return node* nodo da cui iniziare la discesa (la radice se hint non appartiene all'albero o è end())
+     */
+    template<typename Iter>
+    node* start_node(const Iter &hint, const T &value) const{
+        if(hint._ptr == nullptr || hint._tree != this)
+            return _root;
+        return finger_start(const_cast<node*>(hint._ptr), value);
+    }
+
+    /**
+     * @brief Funzione che crea un nuovo nodo e lo collega come figlio del nodo passato
+     * 
+     * @param parent nodo padre (nullptr se l'albero è vuoto)
+     * @param left true se il nodo va collegato come figlio sinistro
+     * @param value valore da memorizzare
+     * @return node* nodo creato
+     * 
+     * @pre il figlio indicato di parent è nullptr
+     * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+     */
+    node* attach(node *parent, bool left, const T &value){
+        node* child = new node(value, parent);
+        _size++;
+        _total++;
+        if(parent == nullptr){
+            _root = _min = _max = child;
+        }else if(left){
+            parent->left = child;
+            if(parent == _min)
+                _min = child;
+        }else{
+            parent->right = child;
+            if(parent == _max)
+                _max = child;
+        }
+        pull_path(child);
+        track(child, eviction());
+        if(_filter != nullptr)
+            filter_insert(value);
+        return child;
+    }
+
+    /**
+     * @brief Funzione che inserisce un valore scendendo a partire dal nodo passato,
+     * senza inserirlo se è già presente
+     * 
+     * @param start nodo da cui iniziare la discesa (nullptr se l'albero è vuoto)
+     * @param value valore da inserire
+     * @param inserted impostato a true se il valore è stato inserito, false se era già presente
+     * @return node* nodo che contiene il valore
+     * 
+     * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+     */
+    node* insert_from(node *start, const T &value, bool &inserted){
+        inserted = false;
+        if(start == nullptr){
+            inserted = true;
+            return attach(nullptr, false, value);
+        }
+
+        node* x = start;
+        while(true){
+            if(_equals(x->value, value)){
+                if(expired(x, eviction())){
+                    revive(x, eviction());
+                    inserted = true;
+                }
+                return x;
+            }
+            bool go_left = less(value, x->value);
+            node* child = go_left ? x->left : x->right;
+            if(child == nullptr){
+                inserted = true;
+                return attach(x, go_left, value);
+            }
+            x = child;
+        }
+    }
+
+    /**
+     * @brief Funzione che cerca un nodo tramite una chiave di tipo diverso da T
+     * 
+     * Eql e Comp devono accettare la chiave insieme a un valore di tipo T
+     * 
+     * @tparam Key tipo della chiave
+     * @param key chiave da cercare
+     * @param parent impostato all'ultimo nodo visitato, cioè al padre della posizione
+     * in cui la chiave andrebbe inserita (nullptr se l'albero è vuoto)
+     * @param left impostato a true se quella posizione è il figlio sinistro di parent
+     * @return node* nodo che corrisponde alla chiave (nullptr se non presente)
+     */
+    template<typename Key>
+    node* find_key(const Key &key, node* &parent, bool &left) const{
+        node* x = _root;
+        parent = nullptr;
+        left = false;
+        while(x != nullptr && !_equals(x->value, key)){
+            parent = x;
+            left = _compare(key, x->value);
+            x = left ? x->left : x->right;
+        }
+        return x;
+    }
+
+    /**
+     * @brief Gestione di un valore già presente in modalità unique_keys
+     * 
+     * @throw existing_node_exception
+     */
+    static void on_duplicate(node*, unique_keys){
+        BST_THROW(existing_node_exception("Cannot insert an existing node in the binary tree"));
+    }
+
+    /**
+     * @brief Gestione di un valore già presente in modalità multi_keys: incrementa
+     * il contatore del nodo senza allocare e senza lanciare eccezioni
+     */
+    void on_duplicate(node *n, multi_keys){
+        n->add_copies(1);
+        _total++;
+        pull_path(n);
+    }
+
+    /**
+     * @brief Funzione che sostituisce, nel padre di u, il sotto-albero u con il sotto-albero v
+     * 
+     * @param u nodo da sostituire
+     * @param v nodo che prende il posto di u (può essere nullptr)
+     */
+    void transplant(node *u, node *v){
+        if(u->parent == nullptr)
+            _root = v;
+        else if(u == u->parent->left)
+            u->parent->left = v;
+        else
+            u->parent->right = v;
+        if(v != nullptr)
+            v->parent = u->parent;
+    }
+
+    /**
+     * @brief Funzione che sposta sul nodo successivo i cursori fermi su un nodo
+     * che sta per essere rimosso
+     * 
+     * @param z nodo da rimuovere, ancora collegato all'albero
+     */
+    void advance_cursors(const node *z) const{
+        const node* next = nullptr;
+        for(cursor* c = _cursors; c != nullptr; c = c->_next){
+            if(c->_ptr == z){
+                if(next == nullptr)
+                    next = successor(z);
+                c->_ptr = next;
+            }
+        }
+    }
+
+    /**
+     * @brief Funzione che porta alla fine tutti i cursori, quando i nodi
+     * dell'albero vengono rimossi o sostituiti tutti insieme
+     */
+    void park_cursors() const{
+        for(cursor* c = _cursors; c != nullptr; c = c->_next)
+            c->_ptr = nullptr;
+    }
+
+    /**
+     * @brief Funzione che stacca un nodo dall'albero e lo dealloca
+     * 
+     * I nodi restanti non vengono spostati né copiati: gli iteratori agli altri
+     * nodi restano validi e i cursori fermi su z passano al successivo
+     * 
+     * @param z nodo da rimuovere
+     */
+    void unlink(node *z){
+        if(_cursors != nullptr)
+            advance_cursors(z);
+        if(_filter != nullptr)
+            _filter->erase(z->value);
+        untrack(z, eviction());
+        if(z == _min)
+            _min = z->right != nullptr ? const_cast<node*>(min_value_node(z->right)) : z->parent;
+        if(z == _max){
+            node* m = z->left;
+            if(m != nullptr){
+                while(m->right != nullptr)
+                    m = m->right;
+            }else{
+                m = z->parent;
+            }
+            _max = m;
+        }
+
+        node* changed = z->parent; // nodo più basso il cui sotto-albero cambia
+        if(z->left == nullptr){
+            transplant(z, z->right);
+        }else if(z->right == nullptr){
+            transplant(z, z->left);
+        }else{
+            node* y = const_cast<node*>(min_value_node(z->right));
+            changed = y;
+            if(y->parent != z){
+                changed = y->parent;
+                transplant(y, y->right);
+                y->right = z->right;
+                y->right->parent = y;
+            }
+            transplant(z, y);
+            y->left = z->left;
+            y->left->parent = y;
+        }
+        _total -= z->count();
+        destroy_node(z);
+        _size--;
+        pull_path(changed);
+    }
+
+    /**
+     * @brief Funzione che rimuove una copia del valore di un nodo, e il nodo
+     * quando resta l'ultima copia
+     * 
+     * @param n nodo da cui rimuovere la copia
+     */
+    void remove_copy(node *n){
+        if(n->count() > 1){
+            n->remove_copy();
+            _total--;
+            pull_path(n);
+        }else{
+            unlink(n);
+        }
+        check_invariants();
+    }
+
+    /**
+     * @brief Numero di ricerche portate avanti insieme dalle ricerche a gruppi
+     */
+    static const unsigned int lookup_group_size = 16;
+
+    /**
+     * @brief Funzione che cerca un gruppo di valori facendo scendere le ricerche
+     * nell'albero un livello alla volta a turno
+     * 
+     * Ad ogni passo viene richiesto il prefetch del nodo successivo di una ricerca
+     * e si passa alla ricerca seguente, in modo che le attese sulla memoria delle
+     * diverse ricerche si sovrappongano
+     * 
+     * @param keys puntatori ai valori da cercare
+     * @param result puntatori ai nodi trovati (nullptr se il valore non è presente)
+     * @param n numero di valori del gruppo (al più lookup_group_size)
+     */
+    void lookup_group(const T* const *keys, const node **result, unsigned int n) const{
+        const node* cur[lookup_group_size];
+        for(unsigned int i = 0; i < n; ++i){
+            cur[i] = _root;
+            result[i] = nullptr;
+        }
+
+        unsigned int active = n;
+        while(active > 0){
+            active = 0;
+            for(unsigned int i = 0; i < n; ++i){
+                const node* c = cur[i];
+                if(c == nullptr)
+                    continue;
+                if(_equals(c->value, *keys[i])){
+                    result[i] = c;
+                    cur[i] = nullptr;
+                    continue;
+                }
+                c = less(*keys[i], c->value) ? c->left : c->right;
+                cur[i] = c;
+                if(c != nullptr){
+                    BST_PREFETCH(c);
+                    ++active;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Funzione che scorre un intervallo di valori a gruppi di lookup_group_size
+     * e passa a visit, nell'ordine dell'intervallo, il nodo trovato per ciascun valore
+     * 
+     * @tparam FwdIt tipo dell'iteratore forward sui valori da cercare
+     * @tparam Visit tipo del funtore chiamato con il nodo trovato (o nullptr)
+     * @param first inizio dell'intervallo
+     * @param last fine dell'intervallo
+     * @param visit funtore da chiamare per ogni valore
+     */
+    template<typename FwdIt, typename Visit>
+    void lookup_batch(FwdIt first, FwdIt last, Visit &visit) const{
+        const T* keys[lookup_group_size];
+        const node* result[lookup_group_size];
+        while(first != last){
+            unsigned int n = 0;
+            for(; n < lookup_group_size && first != last; ++n, ++first)
+                keys[n] = &(*first);
+            lookup_group(keys, result, n);
+            for(unsigned int i = 0; i < n; ++i)
+                visit(live(result[i]));
+        }
+    }
+
+    /**
+     * @brief Funtore usato da contains_batch per scrivere l'esito di ogni ricerca
+     * 
+     * @tparam OutIt tipo dell'iteratore di output
+     */
+    template<typename OutIt>
+    struct contains_visitor{
+        OutIt out;///< posizione in cui scrivere il prossimo esito
+
+        void operator()(const node *n){
+            *out = (n != nullptr);
+            ++out;
+        }
+    };
+
+  
+    public:
+        class const_iterator;
+        class cursor;
+
+        /**
+         * @brief Costruttore di dafault
+         * 
+         * @post _root == nullptr
+         * @post _size == 0
+         * 
+         */
+        binary_search_tree(): _root(nullptr), _size(0), _total(0), _min(nullptr), _max(nullptr), _arena(nullptr), _arena_size(0), _filter(nullptr),
+            _oldest(nullptr), _newest(nullptr), _sweep(nullptr), _capacity(0), _ttl(clock_type::duration::zero()), _timed(false), _cursors(nullptr){}
+
+        /**
+         * @brief Copy constructor
+         * 
+         * Gli alberi con almeno parallel_threshold nodi vengono copiati su più thread
+         * 
+         * @param other albero binario di ricerca da copiare
+         * 
+         * @post _root->value == other._root->value
+         * @post _size == other._size 
+         * 
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        binary_search_tree(const binary_search_tree &other): _root(nullptr), _size(0), _total(0), _min(nullptr), _max(nullptr), _arena(nullptr), _arena_size(0), _filter(nullptr),
+            _oldest(nullptr), _newest(nullptr), _sweep(nullptr), _capacity(other._capacity), _ttl(other._ttl), _timed(other._timed), _cursors(nullptr){   
+            BST_TRY{
+                _root = copy(other._root, nullptr, fork_depth(other._size));
+                _size = other._size;
+                _total = other._total;
+                reset_bounds();
+                copy_uses(other, other._root, eviction());
+                if(other._filter != nullptr)
+                    _filter = new counting_bloom_filter<T>(*other._filter);
+                check_invariants();
+            }BST_CATCH_ALL{
+                clear();
+                delete _filter;
+                BST_RETHROW;
+            }
+        }
+
+        /**
+         * @brief Operatore assegnamento
+         * 
+         * @param other albero binario di ricerca da copiare
+         * @return binary_search_tree& riferimento all'albero this
+         * 
+         * @post _root == other._root
+         * @post _size == other._size
+         */
+        binary_search_tree& operator=(const binary_search_tree &other){
+            if (this != &other){
+                binary_search_tree tmp(other);
+                std::swap(_root, tmp._root);
+                std::swap(_size, tmp._size);
+                std::swap(_total, tmp._total);
+                std::swap(_min, tmp._min);
+                std::swap(_max, tmp._max);
+                std::swap(_arena, tmp._arena);
+                std::swap(_arena_size, tmp._arena_size);
+                std::swap(_filter, tmp._filter);
+                std::swap(_oldest, tmp._oldest);
+                std::swap(_newest, tmp._newest);
+                std::swap(_sweep, tmp._sweep);
+                std::swap(_capacity, tmp._capacity);
+                std::swap(_ttl, tmp._ttl);
+                std::swap(_timed, tmp._timed);
+                park_cursors(); // i cursori restano registrati su this, i loro nodi no
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Distruttore
+         * 
+         */
+        ~binary_search_tree(){
+            clear();
+            delete _filter;
+            while(_cursors != nullptr)
+                _cursors->detach();
+        }
+
+        /**
+         * @brief Funzione che elimina tutti i valori presenti nell'albero binario di
+         * ricerca
+         * 
+         */
+        void clear(){
+            erase(_root);
+            _total = 0;
+            _root = _min = _max = nullptr;
+            release_arena();
+            _oldest = _newest = _sweep = nullptr;
+            park_cursors();
+            if(_filter != nullptr)
+                _filter->clear();
+        }
+
+        /**
+         * @brief Ordine in cui compact() dispone i nodi in memoria
+         */
+        enum compact_layout{
+            in_order_layout,///< ordine dei valori: le visite con const_iterator leggono la memoria in sequenza
+            pre_order_layout///< ordine di visita in profondità: ogni nodo precede i propri sotto-alberi, utile alle ricerche
+        };
+
+        /**
+         * @brief Funzione che ricolloca tutti i nodi in un unico blocco contiguo
+         * nell'ordine richiesto, ricollegando parent, left e right
+         * 
+         * Pensata per le finestre di manutenzione dopo molti inserimenti e rimozioni:
+         * i valori e la forma dell'albero non cambiano, ma gli iteratori esistenti
+         * vengono invalidati (i cursori restano validi). I nodi aggiunti in seguito vengono allocati singolarmente
+         * 
+         * @param layout ordine dei nodi nel blocco
+         * 
+         * @throw std::bad_alloc eccezione durante l'allocazione del blocco (l'albero resta invariato)
+         */
+        void compact(compact_layout layout = in_order_layout){
+            if(_root == nullptr)
+                return;
+
+            std::vector<node*> order;
+            order.reserve(_size);
+            if(layout == in_order_layout){
+                for(node* n = _min; n != nullptr; n = const_cast<node*>(successor(n)))
+                    order.push_back(n);
+            }else{
+                std::vector<node*> stack(1, _root);
+                while(!stack.empty()){
+                    node* n = stack.back();
+                    stack.pop_back();
+                    order.push_back(n);
+                    if(n->right != nullptr)
+                        stack.push_back(n->right);
+                    if(n->left != nullptr)
+                        stack.push_back(n->left);
+                }
+            }
+
+            const std::size_t n = order.size();
+            node* block = static_cast<node*>(::operator new(n * sizeof(node)));
+            std::size_t copied = 0;
+            BST_TRY{
+                // copia dei nodi: il parent del vecchio nodo diventa il puntatore alla sua copia
+                for(; copied < n; ++copied){
+                    new (block + copied) node(*order[copied]);
+                    order[copied]->parent = block + copied;
+                }
+            }BST_CATCH_ALL{
+                for(std::size_t i = 0; i < copied; ++i){
+                    order[i]->parent = block[i].parent;
+                    block[i].~node();
+                }
+                ::operator delete(block);
+                BST_RETHROW;
+            }
+
+            for(std::size_t i = 0; i < n; ++i){
+                node &c = block[i];
+                if(c.parent != nullptr)
+                    c.parent = c.parent->parent;
+                if(c.left != nullptr)
+                    c.left = c.left->parent;
+                if(c.right != nullptr)
+                    c.right = c.right->parent;
+                relink_uses(c, eviction());
+            }
+            _root = _root->parent;
+            _min = _min->parent;
+            _max = _max->parent;
+            if(_oldest != nullptr){
+                _oldest = _oldest->parent;
+                _newest = _newest->parent;
+            }
+            _sweep = nullptr;
+            for(cursor* c = _cursors; c != nullptr; c = c->_next)
+                if(c->_ptr != nullptr)
+                    c->_ptr = c->_ptr->parent;
+
+            for(std::size_t i = 0; i < n; ++i)
+                destroy_node(order[i]);
+            release_arena();
+            _arena = block;
+            _arena_size = n;
+            check_invariants();
+        }
+
+        /**
+         * @brief Funzione che ritorna il valore contenuto nella radice
+         * dell'albero binario di ricerca
+         * 
+         * @return const T& valore memorizzato nella radice
+         * 
+         * @throw empty_tree_exception eccezione lanciata quando si chiama la funzione su un albero vuoto
+         */
+        const T& root() const{
+            if(_root == nullptr)
+                BST_THROW(empty_tree_exception("Cannot get the root value of an empty binary search tree"));
+            
+            return _root->value; 
+        }
+
+        /**
+         * @brief Funzione che ritorna il valore contenuto nella radice senza
+         * lanciare eccezioni
+         * 
+         * @return const T* puntatore al valore memorizzato nella radice (nullptr se l'albero è vuoto)
+         */
+        const T* try_root() const{
+            return _root == nullptr ? nullptr : &_root->value;
+        }
+
+        /**
+         * @brief Funzione che ritorna il valore minimo in tempo costante
+         * 
+         * Con una politica di eviction i valori scaduti vengono saltati
+         * 
+         * @return const T& valore minimo
+         * 
+         * @throw empty_tree_exception eccezione lanciata quando si chiama la funzione su un albero vuoto
+         */
+        const T& min() const{
+            const node* n = skip_expired(_min);
+            if(n == nullptr)
+                BST_THROW(empty_tree_exception("Cannot get the minimum of an empty binary search tree"));
+            return n->value;
+        }
+
+        /**
+         * @brief Funzione che ritorna il valore massimo in tempo costante
+         * 
+         * Con una politica di eviction i valori scaduti vengono saltati
+         * 
+         * @return const T& valore massimo
+         * 
+         * @throw empty_tree_exception eccezione lanciata quando si chiama la funzione su un albero vuoto
+         */
+        const T& max() const{
+            const node* n = _max;
+            while(n != nullptr && expired(n, eviction()))
+                n = predecessor(n);
+            if(n == nullptr)
+                BST_THROW(empty_tree_exception("Cannot get the maximum of an empty binary search tree"));
+            return n->value;
+        }
+
+        /**
+         * @brief Funzione che rimuove e ritorna il valore minimo, per usare l'albero
+         * come coda con priorità modificabile
+         * 
+         * Il nodo viene staccato direttamente, senza ricerca: il nodo minimo non ha
+         * figlio sinistro e il nuovo minimo è il minimo del suo sotto-albero destro
+         * oppure il padre, quindi il costo ammortizzato è costante. In modalità
+         * multi_keys viene rimossa una sola copia. Con una politica di eviction i
+         * valori scaduti incontrati vengono rimossi e saltati
+         * 
+         * @return T valore rimosso
+         * 
+         * @throw empty_tree_exception eccezione lanciata quando si chiama la funzione su un albero vuoto
+         */
+        T pop_min(){
+            while(_min != nullptr && expired(_min, eviction()))
+                unlink(_min);
+            if(_min == nullptr)
+                BST_THROW(empty_tree_exception("Cannot pop the minimum of an empty binary search tree"));
+            T value = _min->value;
+            remove_copy(_min);
+            return value;
+        }
+
+        /**
+         * @brief Funzione che rimuove e ritorna il valore massimo (vedi pop_min)
+         * 
+         * @return T valore rimosso
+         * 
+         * @throw empty_tree_exception eccezione lanciata quando si chiama la funzione su un albero vuoto
+         */
+        T pop_max(){
+            while(_max != nullptr && expired(_max, eviction()))
+                unlink(_max);
+            if(_max == nullptr)
+                BST_THROW(empty_tree_exception("Cannot pop the maximum of an empty binary search tree"));
+            T value = _max->value;
+            remove_copy(_max);
+            return value;
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero dei valori distinti memorizzati
+         * nell'albero binario di ricerca, cioè il numero dei nodi
+         * 
+         * In modalità multi_keys le copie di un valore contano una volta sola:
+         * cinque add(1) danno size() == 1 e count(1) == 5. Il numero degli elementi
+         * contando le copie è total()
+         * 
+         * Con una politica di eviction conta anche i valori scaduti che la pulizia
+         * non ha ancora rimosso (iteratori e ricerche li saltano): per un conteggio
+         * esatto chiamare prima expire()
+         * 
+         * @return std::size_t numero dei valori distinti
+         */
+        std::size_t size() const{
+            return _size;
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero degli elementi memorizzati contando
+         * ogni copia, in tempo costante
+         * 
+         * In modalità unique_keys è uguale a size()
+         * 
+         * @return std::size_t somma di count(v) su tutti i valori v
+         */
+        std::size_t total() const{
+            return _total;
+        }
+
+        /**
+         * @brief Funzione che calcola la memoria occupata dall'albero
+         * 
+         * Visita tutti i nodi: il costo è lineare nel numero dei valori
+         * 
+         * @return memory_stats byte dei nodi, dei valori e persi dall'allocatore
+         */
+        memory_stats memory_usage() const{
+            memory_stats stats;
+            std::size_t in_block = 0;
+            for(const node* n = _min; n != nullptr; n = successor(n)){
+                stats.node_bytes += sizeof(node);
+                stats.payload_bytes += heap_usage<T>::bytes(n->value);
+                if(in_arena(n))
+                    ++in_block;
+                else
+                    stats.slack_bytes += allocation_slack(n, sizeof(node));
+            }
+            if(_arena != nullptr)
+                stats.slack_bytes += (_arena_size - in_block) * sizeof(node) + allocation_slack(_arena, _arena_size * sizeof(node));
+            return stats;
+        }
+
+        /**
+         * @brief Funzione che verifica se l'albero binario di ricerca è vuoto
+         * 
+         * @return true se l'albero è vuoto
+         * @return false se l'albero non è vuoto
+         */
+        bool empty() const{
+            return _root == nullptr;
+        }
+
+        /**
+         * @brief Funzione che ritorna il funtore di comparazione usato dall'albero
+         * 
+         * Chi confronta valori da passare alle ricerche deve usare questa copia,
+         * che conserva l'eventuale stato del funtore, invece di costruirne uno nuovo
+         * 
+         * @return Comp copia del funtore di comparazione
+         */
+        Comp key_comp() const{
+            return _compare;
+        }
+
+        /**
+         * @brief Funzione che aggiunge un nuovo valore nell'albero
+         * 
+         * In modalità multi_keys un valore già presente incrementa il contatore di copie
+         * 
+         * @param value valore da aggiungere
+         * 
+         * @throw existing_node_exception eccezione lanciata se il valore da aggiungere già esiste (solo unique_keys)
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        void add(const T &value){
+            bool inserted;
+            node* n = insert_from(_root, value, inserted); //esegue una new -> non serve try catch 
+            if(!inserted)
+                on_duplicate(n, duplicates());
+            evict(n, eviction());
+            check_invariants();
+        }
+
+        /**
+         * @brief Esito di try_add
+         */
+        enum add_result{
+            add_inserted,///< il valore è stato memorizzato in un nuovo nodo
+            add_duplicate,///< il valore era già presente e l'albero non è cambiato (unique_keys)
+            add_copy///< il valore era già presente e il contatore del nodo è stato incrementato (multi_keys)
+        };
+
+        /**
+         * @brief Funzione che aggiunge un nuovo valore nell'albero senza lanciare
+         * eccezioni per i valori già presenti
+         * 
+         * Da preferire ad add quando i duplicati sono frequenti: l'esito viene
+         * ritornato invece di costruire e lanciare existing_node_exception
+         * 
+         * @param value valore da aggiungere
+         * @return add_result esito dell'inserimento
+         * 
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        add_result try_add(const T &value){
+            bool inserted;
+            node* n = insert_from(_root, value, inserted);
+            if(!inserted && !std::is_same<duplicates, multi_keys>::value)
+                return add_duplicate;
+            if(!inserted){
+                n->add_copies(1);
+                _total++;
+                pull_path(n);
+            }
+            evict(n, eviction());
+            check_invariants();
+            return inserted ? add_inserted : add_copy;
+        }
+
+        /**
+         * @brief Funzione che aggiunge un nuovo valore nell'albero partendo da un
+         * nodo vicino indicato da un iteratore
+         * 
+         * La ricerca della posizione risale da hint tramite parent solo quanto serve
+         * e poi scende: per flussi di valori ordinati o quasi ordinati, passando come hint
+         * l'iteratore ritornato dall'inserimento precedente, il costo è costante ammortizzato
+         * 
+         * @param hint iteratore a un nodo vicino al valore (se end() la ricerca parte dalla radice)
+         * @param value valore da aggiungere
+         * @return const_iterator iteratore al nodo che contiene il valore
+         * 
+         * @throw existing_node_exception eccezione lanciata se il valore da aggiungere già esiste (solo unique_keys)
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        const_iterator add(const_iterator hint, const T &value){
+            bool inserted;
+            node* n = insert_from(start_node(hint, value), value, inserted);
+            if(!inserted)
+                on_duplicate(n, duplicates());
+            evict(n, eviction());
+            check_invariants();
+            return const_iterator(n, this);
+        }
+
+        /**
+         * @brief Funzione che aggiunge all'albero un intervallo di valori
+         * 
+         * I valori vengono ordinati e privati dei duplicati; i valori già presenti
+         * nell'albero vengono ignorati senza lanciare eccezioni (in modalità multi_keys
+         * ogni copia incrementa invece il contatore del nodo). Ogni inserimento
+         * parte dal nodo inserito in precedenza (finger search), così chiavi vicine
+         * riusano lo stesso cammino. Se l'albero è vuoto viene costruito un albero bilanciato
+         * 
+         * @tparam InputIt tipo dell'iteratore sui valori da inserire
+         * @param first inizio dell'intervallo dei valori
+         * @param last fine dell'intervallo dei valori
+         * @return std::size_t numero di valori effettivamente inseriti (in modalità multi_keys tutti)
+         * 
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo (i valori inseriti fino a quel momento restano nell'albero)
+         */
+        template<typename InputIt>
+        std::size_t add_batch(InputIt first, InputIt last){
+            const bool multi = std::is_same<duplicates, multi_keys>::value;
+            std::vector<T> batch(first, last);
+            if(batch.empty())
+                return 0;
+            std::sort(batch.begin(), batch.end(), _compare);
+
+            std::vector<std::size_t> runs;
+            if(multi){
+                for(std::size_t i = 0; i < batch.size(); ++i){
+                    if(i > 0 && _equals(batch[i - 1], batch[i]))
+                        ++runs.back();
+                    else
+                        runs.push_back(1);
+                }
+            }
+            std::size_t total = batch.size();
+            batch.erase(std::unique(batch.begin(), batch.end(), _equals), batch.end());
+
+            if(_root == nullptr){
+                _root = build_balanced(&batch[0], 0, batch.size(), nullptr, fork_depth(batch.size()));
+                _size = batch.size();
+                reset_bounds();
+                if(!std::is_same<eviction, no_eviction>::value)
+                    for(node* n = _min; n != nullptr; n = const_cast<node*>(successor(n)))
+                        track(n, eviction());
+                if(_filter != nullptr){
+                    // _size conta già tutto il lotto: filter_insert ricostruirebbe il filtro al
+                    // primo valore e i successivi verrebbero contati due volte
+                    bool rebuilt = false;
+                    if(_size > _filter->capacity()){
+                        BST_TRY{
+                            rebuild_filter(2 * _size, _filter->false_positive_rate(), _filter->hash());
+                            rebuilt = true;
+                        }BST_CATCH_ALL{}
+                    }
+                    if(!rebuilt)
+                        for(std::size_t i = 0; i < batch.size(); ++i)
+                            _filter->insert(batch[i]);
+                }
+                if(multi){
+                    std::size_t i = 0;
+                    for(node* n = _min; n != nullptr; n = const_cast<node*>(successor(n)), ++i)
+                        n->add_copies(runs[i] - 1);
+                }
+                _total = multi ? total : batch.size();
+                pull_subtree(_root);
+                evict(_max, eviction());
+                check_invariants();
+                return multi ? total : batch.size();
+            }
+
+            std::size_t count = 0;
+            node* finger = nullptr;
+            for(std::size_t i = 0; i < batch.size(); ++i){
+                bool inserted;
+                finger = insert_from(finger == nullptr ? _root : finger_start(finger, batch[i]), batch[i], inserted);
+                if(inserted)
+                    ++count;
+                if(multi){
+                    finger->add_copies(inserted ? runs[i] - 1 : runs[i]);
+                    _total += inserted ? runs[i] - 1 : runs[i];
+                    pull_path(finger);
+                }
+            }
+            evict(finger, eviction());
+            check_invariants();
+            return multi ? total : count;
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero di copie di un valore
+         * 
+         * @param value valore da cercare
+         * @return std::size_t numero di copie (0 se il valore non è presente, al più 1 in modalità unique_keys)
+         */
+        std::size_t count(const T &value) const{
+            if(_filter != nullptr && !_filter->may_contain(value))
+                return 0;
+            const node* n = find_node(_root, value);
+            return n == nullptr || expired(n, eviction()) ? 0 : n->count();
+        }
+
+        /**
+         * @brief Funzione che ritorna il riepilogo di tutti i valori dell'albero
+         * 
+         * Disponibile solo se Policy::aggregate non è no_aggregate
+         * 
+         * @return riepilogo dei valori in ordine (identity() se l'albero è vuoto)
+         */
+        template<typename Agg = aggregate_type>
+        typename Agg::value_type aggregate() const{
+            static_assert(std::is_same<Agg, aggregate_type>::value, "the aggregate must be Policy::aggregate");
+            return _root == nullptr ? Agg::identity() : _root->summary;
         }
-        
-    }
 
-    /**
-     * @brief Funzione che ritorna il puntatore al nodo che contiene il valore
-     * più piccolo presente nell'albero binario di ricerca passato come paramento
-     * 
-     * @param root radice dell'albero binario di ricerca
-     * @return const node* const puntatore al nodo in cui è presente il valore più piccolo
-     */
-    const node* const min_value_node(const node* const root) const{
-        if(root == nullptr)
-            return root;
-        if(root->left == nullptr)
-            return root;
-        return min_value_node(root->left);   
-    }
+        /**
+         * @brief Funzione che ritorna il riepilogo dei valori compresi tra a e b (estremi inclusi)
+         * 
+         * Usa i riepiloghi memorizzati nei nodi: visita solo i due cammini verso a e
+         * verso b, quindi il costo è proporzionale all'altezza dell'albero e non al
+         * numero dei valori nell'intervallo. Disponibile solo se Policy::aggregate
+         * non è no_aggregate
+         * 
+         * @param a estremo inferiore
+         * @param b estremo superiore
+         * @return riepilogo dei valori dell'intervallo in ordine (identity() se vuoto)
+         */
+        template<typename Agg = aggregate_type>
+        typename Agg::value_type aggregate(const T &a, const T &b) const{
+            static_assert(std::is_same<Agg, aggregate_type>::value, "the aggregate must be Policy::aggregate");
+            // primo nodo dell'intervallo incontrato scendendo: i due cammini si separano qui
+            const node* split = _root;
+            while(split != nullptr){
+                if(less(split->value, a))
+                    split = split->right;
+                else if(less(b, split->value))
+                    split = split->left;
+                else
+                    break;
+            }
+            if(split == nullptr)
+                return Agg::identity();
 
-    
-    /**
-     * @brief Funzione che inserisce nell'albero binario di ricerca
-     * il valore passato come parametro e ritorna un nuovo albero binario
-     * di ricerca con il nuovo nodo agginto
-     * 
-     * @param root radice dell'albero binario di ricerca
-     * @param value valore da inserire
-     * @param parent puntatore al nodo padre del nuovo nodo
-     * @return node* puntatore alla radice del nuovo albero binario di ricerca
-     */
-    node* const insert(node* root, const T &value, node* const parent = nullptr){
-        node* tree_node = nullptr;
-        if(root == nullptr){
-            root = new node(value, parent);
-            _size++;
-            return root;
+            // valori >= a nel sotto-albero sinistro, accumulati da destra verso sinistra
+            typename Agg::value_type low = Agg::identity();
+            for(const node* n = split->left; n != nullptr;){
+                if(less(n->value, a)){
+                    n = n->right;
+                }else{
+                    typename Agg::value_type s = Agg::lift(n->value, n->count());
+                    if(n->right != nullptr)
+                        s = Agg::combine(s, n->right->summary);
+                    low = Agg::combine(s, low);
+                    n = n->left;
+                }
+            }
+            // valori <= b nel sotto-albero destro, accumulati da sinistra verso destra
+            typename Agg::value_type high = Agg::identity();
+            for(const node* n = split->right; n != nullptr;){
+                if(less(b, n->value)){
+                    n = n->left;
+                }else{
+                    typename Agg::value_type s = Agg::lift(n->value, n->count());
+                    if(n->left != nullptr)
+                        s = Agg::combine(n->left->summary, s);
+                    high = Agg::combine(high, s);
+                    n = n->right;
+                }
+            }
+            return Agg::combine(Agg::combine(low, Agg::lift(split->value, split->count())), high);
         }
 
-        if(_compare(value, root->value))
-            root->left = insert(root->left, value, root);
-        else
-            root->right = insert(root->right, value, root);
-
-        return root;
-    }
+        /**
+         * @brief Funzione che rimuove un valore, con tutte le sue copie, dall'albero
+         * 
+         * Gli iteratori agli altri valori restano validi. Un valore scaduto è
+         * considerato assente, come per contains: viene rimosso e la funzione ritorna false
+         * 
+         * @param value valore da rimuovere
+         * @return true se il valore era presente ed è stato rimosso
+         * @return false se il valore non era presente
+         */
+        bool remove(const T &value){
+            node* n = purge_expired(const_cast<node*>(find_node(_root, value)));
+            if(n == nullptr)
+                return false;
+            unlink(n);
+            check_invariants();
+            return true;
+        }
 
-  
-    public:
+        /**
+         * @brief Funzione che rimuove una copia di un valore: decrementa il contatore
+         * del nodo e rimuove il nodo solo quando resta l'ultima copia (un valore
+         * scaduto è considerato assente, vedi remove)
+         * 
+         * @param value valore da rimuovere
+         * @return true se il valore era presente
+         * @return false se il valore non era presente
+         */
+        bool remove_one(const T &value){
+            node* n = purge_expired(const_cast<node*>(find_node(_root, value)));
+            if(n == nullptr)
+                return false;
+            remove_copy(n);
+            return true;
+        }
 
         /**
-         * @brief Costruttore di dafault
+         * @brief Funzione che verifica se un valore è presente nell'albero binario 
+         * di ricerca
          * 
-         * @post _root == nullptr
-         * @post _size == 0
+         * Con le politiche splay_access e transpose_access il nodo trovato viene
+         * avvicinato alla radice (le ricerche concorrenti richiedono quindi un lock esterno)
+         * 
+         * @param value valore da cercare 
+         * @return true se il valore è presente nell'albero
+         * @return false se il valore non è presente nell'albero
          * 
+         * @throw empty_tree_exception eccezione lanciata in caso di albero vuoto
          */
-        binary_search_tree(): _root(nullptr), _size(0){}
+        bool contains(const T &value) const{
+            if(_filter == nullptr)
+                return access_node(value) != nullptr;
+            if(!_filter->may_contain(value))
+                return false;
+            bool found = access_node(value) != nullptr;
+            _filter->record(found);
+            return found;
+        }
 
         /**
-         * @brief Copy constructor
+         * @brief Funzione che attiva un filtro di appartenenza davanti alle ricerche
          * 
-         * @param other albero binario di ricerca da copiare
+         * contains e find consultano prima un filtro di Bloom a contatori, mantenuto
+         * aggiornato da inserimenti, rimozioni e clear: i valori sicuramente assenti
+         * vengono scartati senza scendere nell'albero. Il filtro occupa circa
+         * -ln(fp_rate) / ln(2)^2 byte per valore e raddoppia quando i valori
+         * superano la capacità. Se il filtro è già attivo viene ricreato
          * 
-         * @post _root->value == other._root->value
-         * @post _size == other._size 
+         * @tparam Hash funtore hash dei valori
+         * @param fp_rate probabilità di falso positivo desiderata (tra 0 e 1)
+         * @param capacity numero di valori previsto (0 per il doppio dei valori attuali)
          * 
-         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         * @throw std::bad_alloc eccezione durante l'allocazione del filtro
          */
-        binary_search_tree(const binary_search_tree &other): _root(nullptr), _size(0){   
-            try{
-                _root = copy(other._root);
-                _size = other._size;
-            }catch(...){
-                clear();
-                throw;
-            }
+        template<typename Hash>
+        void enable_filter(double fp_rate = 0.01, std::size_t capacity = 0){
+            if(capacity < _size)
+                capacity = 2 * _size;
+            rebuild_filter(capacity, fp_rate, &hash_thunk<Hash>);
         }
 
         /**
-         * @brief Operatore assegnamento
+         * @brief Funzione che attiva il filtro di appartenenza con std::hash<T>
          * 
-         * @param other albero binario di ricerca da copiare
-         * @return binary_search_tree& riferimento all'albero this
+         * @param fp_rate probabilità di falso positivo desiderata (tra 0 e 1)
+         * @param capacity numero di valori previsto (0 per il doppio dei valori attuali)
          * 
-         * @post _root == other._root
-         * @post _size == other._size
+         * @throw std::bad_alloc eccezione durante l'allocazione del filtro
          */
-        binary_search_tree& operator=(const binary_search_tree &other){
-            if (this != &other){
-                binary_search_tree tmp(other);
-                std::swap(_root, tmp._root);
-                std::swap(_size, tmp._size);
-            }
-            return *this;
+        void enable_filter(double fp_rate = 0.01, std::size_t capacity = 0){
+            enable_filter<std::hash<T> >(fp_rate, capacity);
         }
 
         /**
-         * @brief Distruttore
+         * @brief Funzione che disattiva e dealloca il filtro di appartenenza
          * 
          */
-        ~binary_search_tree(){
-            clear();
+        void disable_filter(){
+            delete _filter;
+            _filter = nullptr;
         }
 
         /**
-         * @brief Funzione che elimina tutti i valori presenti nell'albero binario di
-         * ricerca
+         * @brief Funzione che ritorna i contatori del filtro di appartenenza,
+         * utili per scegliere fp_rate (con ricerche concorrenti sono approssimati)
          * 
+         * @return filter_stats contatori delle ricerche (tutti zero se il filtro non è attivo)
          */
-        void clear(){
-            erase(_root);
-            _root = nullptr;
+        filter_stats filter_statistics() const{
+            return _filter == nullptr ? filter_stats() : _filter->statistics();
         }
 
         /**
-         * @brief Funzione che ritorna il valore contenuto nella radice
-         * dell'albero binario di ricerca
+         * @brief Funzione che imposta il numero massimo di elementi
+         *
+         * La capacità si confronta con total(), quindi in modalità multi_keys ogni
+         * copia conta. Oltre la capacità ogni inserimento rimuove una copia del
+         * valore più vecchio della lista d'uso (il primo inserito con fifo_eviction,
+         * il meno usato con lru_eviction) e il nodo quando resta l'ultima copia;
+         * del valore appena inserito vengono rimosse solo le copie in più.
+         * Se l'albero contiene già più elementi, i più vecchi vengono rimossi subito.
+         * Disponibile solo se Policy::eviction non è no_eviction
+         *
+         * @param capacity numero massimo di elementi (0 senza limite)
+         */
+        void set_capacity(std::size_t capacity){
+            static_assert(!std::is_same<eviction, no_eviction>::value, "set_capacity needs an eviction policy");
+            _capacity = capacity;
+            if(_capacity != 0)
+                while(_total > _capacity && evict_copy(nullptr)){}
+            check_invariants();
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero massimo di elementi
+         *
+         * @return std::size_t capacità (0 senza limite)
+         */
+        std::size_t capacity() const{
+            return _capacity;
+        }
+
+        /**
+         * @brief Funzione che imposta la durata dei valori inseriti da questo momento
+         *
+         * Un valore scaduto risulta assente a contains, find, count e alle visite e viene rimosso
+         * dagli inserimenti successivi (al più pochi nodi per inserimento, così il
+         * costo resta costante) oppure da expire(). Aggiungere di nuovo un valore
+         * scaduto lo riporta in vita con una nuova scadenza. Disponibile solo se
+         * Policy::eviction non è no_eviction
+         *
+         * @param ttl durata dei valori (zero: i valori inseriti non scadono)
+         */
+        void set_ttl(std::chrono::steady_clock::duration ttl){
+            static_assert(!std::is_same<eviction, no_eviction>::value, "set_ttl needs an eviction policy");
+            _ttl = ttl;
+            if(_ttl != clock_type::duration::zero())
+                _timed = true;
+        }
+
+        /**
+         * @brief Funzione che imposta la scadenza di un singolo valore
+         *
+         * Disponibile solo se Policy::eviction non è no_eviction
+         *
+         * @param value valore presente nell'albero
+         * @param when istante di scadenza
+         * @return true se il valore era presente e non scaduto
+         * @return false altrimenti
+         */
+        bool expire_at(const T &value, std::chrono::steady_clock::time_point when){
+            static_assert(!std::is_same<eviction, no_eviction>::value, "expire_at needs an eviction policy");
+            node* n = const_cast<node*>(find_node(_root, value));
+            if(n == nullptr || expired(n, eviction()))
+                return false;
+            n->expires = when;
+            _timed = true;
+            return true;
+        }
+
+        /**
+         * @brief Funzione che rimuove subito tutti i valori scaduti
+         *
+         * Visita l'intera lista d'uso: serve quando size() e total() non
+         * devono più contare i valori scaduti che la pulizia incrementale non ha
+         * ancora raggiunto
+         *
+         * @return std::size_t numero dei nodi rimossi
+         */
+        std::size_t expire(){
+            static_assert(!std::is_same<eviction, no_eviction>::value, "expire needs an eviction policy");
+            std::size_t removed = 0;
+            if(!_timed)
+                return removed;
+            clock_type::time_point now = clock_type::now();
+            for(node* n = _oldest; n != nullptr;){
+                node* next = n->newer;
+                if(n->expires <= now){
+                    unlink(n);
+                    ++removed;
+                }
+                n = next;
+            }
+            check_invariants();
+            return removed;
+        }
+
+        /**
+         * @brief Funzione che cerca un valore nell'albero binario di ricerca
          * 
-         * @return const T& valore memorizzato nella radice
+         * Applica la politica di accesso come contains
          * 
-         * @throw empty_tree_exception eccezione lanciata quando si chiama la funzione su un albero vuoto
+         * @param value valore da cercare
+         * @return const_iterator iteratore al nodo che contiene il valore (end() se non presente)
          */
-        const T& root() const{
-            if(_root == nullptr)
-                throw empty_tree_exception("Cannot get the root value of an empty binary search tree");
-            
-            return _root->value; 
+        const_iterator find(const T &value) const{
+            if(_filter == nullptr)
+                return const_iterator(access_node(value), this);
+            if(!_filter->may_contain(value))
+                return end();
+            const node* n = access_node(value);
+            _filter->record(n != nullptr);
+            return const_iterator(n, this);
         }
 
         /**
-         * @brief Funzione che ritorna il numero dei valori memorizzati nell'albero
-         * binario di ricerca
+         * @brief Funzione che cerca un valore partendo da un nodo vicino indicato da un iteratore
          * 
-         * @return unsigned int numero degli elementi memorizzati
+         * Il costo è logaritmico nella distanza tra il valore e hint invece che
+         * proporzionale all'altezza dell'albero
+         * 
+         * Come find(value) consulta il filtro e non trova i valori scaduti, ma non
+         * applica la politica di accesso
+         * 
+         * @param hint iteratore a un nodo vicino al valore (se end() la ricerca parte dalla radice)
+         * @param value valore da cercare
+         * @return const_iterator iteratore al nodo che contiene il valore (end() se non presente)
          */
-        unsigned int size() const{
-            return _size;
+        const_iterator find(const_iterator hint, const T &value) const{
+            if(_filter != nullptr && !_filter->may_contain(value))
+                return end();
+            const node* n = live(find_node(start_node(hint, value), value));
+            if(_filter != nullptr)
+                _filter->record(n != nullptr);
+            return const_iterator(n, this);
         }
 
         /**
-         * @brief Funzione che verifica se l'albero binario di ricerca è vuoto
+         * @brief Funzione che ritorna un iteratore al primo valore non minore di value
          * 
-         * @return true se l'albero è vuoto
-         * @return false se l'albero non è vuoto
+         * @param value valore da cercare
+         * @return const_iterator iteratore al primo valore v tale che !Comp(v, value) (end() se non esiste)
          */
-        bool empty() const{
-            return _root == nullptr;
+        const_iterator lower_bound(const T &value) const{
+            const node* x = _root;
+            const node* result = nullptr;
+            while(x != nullptr){
+                if(less(x->value, value)){
+                    x = x->right;
+                }else{
+                    result = x;
+                    x = x->left;
+                }
+            }
+            return const_iterator(skip_expired(result), this);
         }
 
         /**
-         * @brief Funzione che aggiunge un nuovo valore nell'albero
+         * @brief Funzione che, dato un predicato monotono vero su un prefisso dei valori
+         * ordinati e falso sul resto, ritorna l'iteratore al primo valore che non lo soddisfa
          * 
-         * @param value valore da aggiungere
+         * La ricerca scende dalla radice scartando interi sotto-alberi, quindi
+         * costa quanto l'altezza dell'albero
          * 
-         * @throw existing_node_exception eccezione lanciata se il valore da aggiungere già esiste
-         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         * @tparam P tipo del predicato
+         * @param pred predicato monotono
+         * @return const_iterator iteratore al primo valore per cui pred è falso (end() se non esiste)
          */
-        void add(const T &value){
-            if(contains(value))
-                throw existing_node_exception("Cannot insert an existing node in the binary tree");
-            
-            _root = insert(_root, value); //esegue una new -> non serve try catch 
+        template<typename P>
+        const_iterator partition_point(P pred) const{
+            const node* x = _root;
+            const node* result = nullptr;
+            while(x != nullptr){
+                if(pred(x->value)){
+                    x = x->right;
+                }else{
+                    result = x;
+                    x = x->left;
+                }
+            }
+            return const_iterator(skip_expired(result), this);
         }
 
         /**
-         * @brief Funzione che verifica se un valore è presente nell'albero binario 
-         * di ricerca
+         * @brief Funzione che verifica la presenza di un intervallo di valori 
+         * nell'albero binario di ricerca
          * 
-         * @param value valore da cercare 
-         * @return true se il valore è presente nell'albero
-         * @return false se il valore non è presente nell'albero
+         * Le ricerche vengono eseguite a gruppi, alternando la discesa di una ricerca
+         * con quella delle altre, così le attese sulla memoria si sovrappongono.
+         * Conviene rispetto a chiamate ripetute di contains su alberi grandi
          * 
-         * @throw empty_tree_exception eccezione lanciata in caso di albero vuoto
+         * @tparam FwdIt tipo dell'iteratore forward sui valori da cercare
+         * @tparam OutIt tipo dell'iteratore di output su cui scrivere gli esiti (bool)
+         * @param first inizio dell'intervallo dei valori da cercare
+         * @param last fine dell'intervallo dei valori da cercare
+         * @param out inizio della sequenza in cui scrivere gli esiti, nello stesso ordine dei valori
+         * @return OutIt posizione successiva all'ultimo esito scritto
          */
-        bool contains(const T &value) const{
-            return contains_value(_root, value);
+        template<typename FwdIt, typename OutIt>
+        OutIt contains_batch(FwdIt first, FwdIt last, OutIt out) const{
+            contains_visitor<OutIt> visit = {out};
+            lookup_batch(first, last, visit);
+            return visit.out;
+        }
+
+        /**
+         * @brief Funzione che cerca un intervallo di valori nell'albero binario di ricerca
+         * e ritorna, per ogni valore, un iteratore al nodo che lo contiene
+         * 
+         * @tparam FwdIt tipo dell'iteratore forward sui valori da cercare
+         * @tparam OutIt tipo dell'iteratore di output su cui scrivere i const_iterator
+         * @param first inizio dell'intervallo dei valori da cercare
+         * @param last fine dell'intervallo dei valori da cercare
+         * @param out inizio della sequenza in cui scrivere gli iteratori (end() se il valore non è presente)
+         * @return OutIt posizione successiva all'ultimo iteratore scritto
+         */
+        template<typename FwdIt, typename OutIt>
+        OutIt find_batch(FwdIt first, FwdIt last, OutIt out) const{
+            find_visitor<OutIt> visit = {out, this};
+            lookup_batch(first, last, visit);
+            return visit.out;
         }
 
     
@@ -399,12 +2819,23 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
             if(_root == nullptr)
                 return subtree;
 
-            try{
-                subtree._root = copy(get_node(_root, d));
+            BST_TRY{
+                const node* source = find_node(_root, d);
+                subtree._root = copy(source, nullptr, fork_depth(_size));
                 subtree._size = count_node(subtree._root);
-            }catch(...){
+                subtree.reset_bounds();
+                subtree._total = subtree._size;
+                if(std::is_same<duplicates, multi_keys>::value)
+                    for(const node* n = subtree._min; n != nullptr; n = successor(n))
+                        subtree._total += n->count() - 1;
+                subtree._capacity = _capacity;
+                subtree._ttl = _ttl;
+                subtree._timed = _timed;
+                subtree.copy_uses(*this, source, eviction());
+                subtree.check_invariants();
+            }BST_CATCH_ALL{
                 subtree.clear();
-                throw;
+                BST_RETHROW;
             }
             return subtree;
         }
@@ -431,7 +2862,10 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
 	
         /**
          * Classe const_iterator
-         * Gli iteratori iterano sui dati contenuti nel albero binario di ricerca
+         * Gli iteratori iterano sui dati contenuti nel albero binario di ricerca.
+         * Un iteratore resta valido finché il suo nodo non viene rimosso; compact(),
+         * clear() e l'assegnamento li invalidano tutti. Per le scansioni che devono
+         * sopravvivere alle modifiche dell'albero si usa cursor
          * @brief Classe const_iterator
          */
         class const_iterator {
@@ -447,14 +2881,14 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
                  * @brief Costruttore di default
                  * 
                  */
-                const_iterator() : _ptr(nullptr) {}
+                const_iterator() : _tree(nullptr), _ptr(nullptr) {}
                 
                 /**
                  * @brief Copy constructor
                  * 
                  * @param other iteratore da cui copiare i dati
                  */
-                const_iterator(const const_iterator &other) : _ptr(other._ptr){}
+                const_iterator(const const_iterator &other) : _tree(other._tree), _ptr(other._ptr){}
 
                 /**
                  * @brief Operatore assegnamento
@@ -463,6 +2897,7 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
                  * @return reference all'iteratore this 
                  */
                 const_iterator& operator=(const const_iterator &other) {
+                    _tree=other._tree;
                     _ptr=other._ptr;
                     return *this;
                 }
@@ -548,26 +2983,17 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
                  * @post _ptr == n
                  * @post _tree == t
                  */
-                const_iterator(const node *n, const binary_search_tree* t): _ptr(n), _tree(t) {}
+                const_iterator(const node *n, const binary_search_tree* t): _tree(t), _ptr(n) {}
 
                 /**
                  * @brief Funzione che sposta il puntatore passato in input al nodo
-                 * successivo
+                 * successivo, saltando i valori scaduti
                  * 
                  * @param ptr puntatore al nodo
                  * @return const node* const puntatore nodo successivo
                  */
                 const node* const next(const node* ptr){
-                    if(ptr == nullptr)
-                        return ptr;
-                    if(ptr->right != nullptr){
-                        return _tree->min_value_node(ptr->right); // successore di ptr è il minimo del sotto albero destro
-                    }else{
-                        while (ptr->parent != nullptr && ptr == ptr->parent->right){//risale l'albero
-                                ptr = ptr->parent;
-                        }
-                        return ptr->parent;
-                    }
+                    return _tree->skip_expired(successor(ptr));
                 } 
             
             
@@ -576,10 +3002,13 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
         /**
          * @brief Iteratore di inzio
          * 
+         * Parte dal minimo memorizzato, come min(): con una politica di eviction
+         * l'iteratore salta i valori scaduti anche durante la visita
+         * 
          * @return const_iterator
          */
         const_iterator begin() const {
-            return const_iterator(min_value_node(_root), this);
+            return const_iterator(skip_expired(_min), this);
         }
         
         /**
@@ -590,6 +3019,256 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
         const_iterator end() const {
             return const_iterator(nullptr, this);
         }
+
+        /**
+         * @brief Classe cursor
+         * 
+         * Posizione in una visita in ordine che resta valida mentre l'albero viene
+         * modificato: il cursore si registra sull'albero e, a differenza di
+         * const_iterator, viene aggiornato dalle modifiche. Se il valore su cui è
+         * fermo viene rimosso (anche da un'eviction) il cursore passa al valore
+         * successivo, compact() lo sposta sulla nuova copia del nodo e clear() o
+         * l'assegnamento lo portano alla fine. I valori aggiunti dopo la posizione
+         * del cursore vengono visitati, quelli aggiunti prima no. Con una politica di
+         * eviction i valori scaduti vengono saltati, anche quello su cui il cursore
+         * era fermo quando è scaduto.
+         * Una scansione a pagine può quindi fermarsi e riprendere in tempo costante,
+         * senza una nuova ricerca dalla radice. Ogni cursore aperto aggiunge un
+         * controllo a ogni rimozione; come per le altre modifiche, l'uso da più
+         * thread va sincronizzato
+         */
+        class cursor{
+            public:
+                typedef T value_type;
+                typedef const T* pointer;
+                typedef const T& reference;
+
+                /**
+                 * @brief Costruttore di default: cursore non collegato a nessun albero
+                 * 
+                 */
+                cursor(): _tree(nullptr), _ptr(nullptr), _prev(nullptr), _next(nullptr){}
+
+                /**
+                 * @brief Copy constructor: il nuovo cursore si registra sullo stesso albero
+                 * 
+                 * @param other cursore da copiare
+                 */
+                cursor(const cursor &other): _tree(nullptr), _ptr(nullptr), _prev(nullptr), _next(nullptr){
+                    attach(other._tree, other._ptr);
+                }
+
+                /**
+                 * @brief Operatore assegnamento
+                 * 
+                 * @param other cursore da copiare
+                 * @return cursor& reference al cursore this
+                 */
+                cursor& operator=(const cursor &other){
+                    if(this != &other){
+                        detach();
+                        attach(other._tree, other._ptr);
+                    }
+                    return *this;
+                }
+
+                /**
+                 * @brief Distruttore: il cursore si cancella dall'albero
+                 * 
+                 */
+                ~cursor(){
+                    detach();
+                }
+
+                /**
+                 * @brief Operatore*
+                 * 
+                 * @return reference al valore su cui è fermo il cursore
+                 * 
+                 * @pre !at_end()
+                 */
+                reference operator*() const{
+                    settle();
+                    return _ptr->value;
+                }
+
+                /**
+                 * @brief Operatore->
+                 * 
+                 * @return puntatore al valore su cui è fermo il cursore
+                 * 
+                 * @pre !at_end()
+                 */
+                pointer operator->() const{
+                    settle();
+                    return &(_ptr->value);
+                }
+
+                /**
+                 * @brief Operatore++ pre-incremento: passa al valore successivo
+                 * 
+                 * @return reference al cursore this
+                 */
+                cursor& operator++(){
+                    settle();
+                    _ptr = successor(_ptr);
+                    settle();
+                    return *this;
+                }
+
+                /**
+                 * @brief Funzione che verifica se il cursore ha superato l'ultimo valore
+                 * 
+                 * @return true se non ci sono altri valori da visitare (o il cursore non è collegato)
+                 * @return false altrimenti
+                 */
+                bool at_end() const{
+                    settle();
+                    return _ptr == nullptr;
+                }
+
+                /**
+                 * @brief Funzione che ritorna un iteratore alla posizione corrente, valido
+                 * fino alla prossima modifica dell'albero
+                 * 
+                 * @return const_iterator iteratore al valore corrente (end() se at_end())
+                 */
+                const_iterator position() const{
+                    settle();
+                    return const_iterator(_ptr, _tree);
+                }
+
+                /**
+                 * @brief Funzione che copia i prossimi valori e avanza il cursore
+                 * 
+                 * @tparam OutIt tipo dell'iteratore di output
+                 * @param n numero massimo di valori da copiare
+                 * @param out destinazione dei valori
+                 * @return std::size_t numero di valori copiati (meno di n solo alla fine)
+                 */
+                template<typename OutIt>
+                std::size_t read(std::size_t n, OutIt out){
+                    std::size_t copied = 0;
+                    for(settle(); copied < n && _ptr != nullptr; ++copied){
+                        *out = _ptr->value;
+                        ++out;
+                        _ptr = successor(_ptr);
+                        settle();
+                    }
+                    return copied;
+                }
+
+            private:
+                friend class binary_search_tree;///< friend della classe binary_search_tree
+                const binary_search_tree* _tree;///< albero su cui il cursore è registrato (nullptr se nessuno)
+                mutable const node* _ptr;///< prossimo valore da visitare (nullptr alla fine)
+                cursor* _prev;///< cursore precedente nella lista dei cursori dell'albero
+                cursor* _next;///< cursore successivo nella lista dei cursori dell'albero
+
+                /**
+                 * @brief Costruttore privato usato da open_cursor
+                 * 
+                 * @param t albero su cui registrare il cursore
+                 * @param n nodo da cui partire (nullptr per la fine)
+                 */
+                cursor(const binary_search_tree *t, const node *n): _tree(nullptr), _ptr(nullptr), _prev(nullptr), _next(nullptr){
+                    attach(t, n);
+                }
+
+                /**
+                 * @brief Sposta il cursore oltre i valori scaduti (nessun effetto senza eviction)
+                 */
+                void settle() const{
+                    if(_ptr != nullptr)
+                        _ptr = _tree->skip_expired(_ptr);
+                }
+
+                /**
+                 * @brief Registra il cursore in testa alla lista dei cursori di un albero
+                 * 
+                 * @param t albero (se nullptr il cursore resta scollegato)
+                 * @param n nodo di partenza
+                 */
+                void attach(const binary_search_tree *t, const node *n){
+                    _tree = t;
+                    _ptr = n;
+                    if(t == nullptr)
+                        return;
+                    _prev = nullptr;
+                    _next = t->_cursors;
+                    if(_next != nullptr)
+                        _next->_prev = this;
+                    t->_cursors = this;
+                }
+
+                /**
+                 * @brief Cancella il cursore dalla lista del suo albero
+                 * 
+                 * @post _tree == nullptr && _ptr == nullptr
+                 */
+                void detach(){
+                    if(_tree != nullptr){
+                        if(_prev != nullptr)
+                            _prev->_next = _next;
+                        else
+                            _tree->_cursors = _next;
+                        if(_next != nullptr)
+                            _next->_prev = _prev;
+                    }
+                    _tree = nullptr;
+                    _ptr = nullptr;
+                    _prev = _next = nullptr;
+                }
+        }; // classe cursor
+
+        /**
+         * @brief Funzione che apre un cursore sul valore minimo
+         * 
+         * @return cursor cursore registrato su questo albero
+         */
+        cursor open_cursor() const{
+            return cursor(this, _min);
+        }
+
+        /**
+         * @brief Funzione che apre un cursore nella posizione di un iteratore, ad
+         * esempio quello ritornato da lower_bound
+         * 
+         * @param position iteratore di questo albero
+         * @return cursor cursore registrato su questo albero
+         */
+        cursor open_cursor(const_iterator position) const{
+            return cursor(this, position._ptr);
+        }
+
+    private:
+        mutable cursor* _cursors;///< cursori aperti su questo albero (lista doppiamente collegata, nullptr se nessuno)
+
+        /**
+         * @brief Funzione che crea un iteratore al nodo passato
+         * 
+         * @param n nodo a cui l'iteratore fa riferimento (nullptr per end())
+         * @return const_iterator
+         */
+        const_iterator make_iterator(const node *n) const{
+            return const_iterator(n, this);
+        }
+
+        /**
+         * @brief Funtore usato da find_batch per scrivere l'iteratore di ogni ricerca
+         * 
+         * @tparam OutIt tipo dell'iteratore di output
+         */
+        template<typename OutIt>
+        struct find_visitor{
+            OutIt out;///< posizione in cui scrivere il prossimo iteratore
+            const binary_search_tree* tree;///< albero su cui si esegue la ricerca
+
+            void operator()(const node *n){
+                *out = const_iterator(n, tree);
+                ++out;
+            }
+        };
 	
 };
 
@@ -600,13 +3279,14 @@ template<typename T, typename Eql, typename Comp> class binary_search_tree{
  * @tparam T tipo dei valori nell'albero
  * @tparam Eql funtore di uguaglianza
  * @tparam Comp funtore di comparazione
+ * @tparam Policy politiche dell'albero
  * @tparam P tipo del predicato
  * @param bst oggetto albero binario di ricerca
  * @param pred funtore predicato
  */
-template<typename T, typename Eql, typename Comp, typename P>
-void printIF(const binary_search_tree<T, Eql, Comp> &bst, P pred){
-    typename binary_search_tree<T, Eql, Comp>::const_iterator b,e;
+template<typename T, typename Eql, typename Comp, typename Policy, typename P>
+void printIF(const binary_search_tree<T, Eql, Comp, Policy> &bst, P pred){
+    typename binary_search_tree<T, Eql, Comp, Policy>::const_iterator b,e;
     b = bst.begin();
     e = bst.end();
     while(b != e){
@@ -0,0 +1,220 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+#include <vector>
+#include <atomic>
+#include <cmath>    // std::log, std::ceil
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint64_t
+
+/**
+ * @brief Contatori di un filtro di appartenenza, ritornati da filter_statistics()
+ */
+struct filter_stats{
+    std::size_t lookups;///< ricerche passate dal filtro
+    std::size_t filtered;///< ricerche concluse dal filtro senza visitare l'albero (valore sicuramente assente)
+    std::size_t false_positives;///< ricerche che il filtro ha lasciato passare per valori assenti
+
+    filter_stats(): lookups(0), filtered(0), false_positives(0){}
+};
+
+/**
+ * @brief Classe counting_bloom_filter
+ *
+ * Filtro di Bloom a contatori: ogni valore incrementa k contatori scelti da una
+ * funzione hash e la rimozione li decrementa, così il filtro segue inserimenti e
+ * rimozioni. Se anche un solo contatore è zero il valore è sicuramente assente;
+ * altrimenti è probabilmente presente, con la probabilità di falso positivo
+ * scelta alla costruzione finché i valori non superano la capacità.
+ * I contatori arrivati a 255 non vengono più modificati, così il filtro non
+ * produce mai falsi negativi
+ *
+ * @tparam T tipo dei valori
+ */
+template<typename T>
+class counting_bloom_filter{
+    public:
+        typedef std::size_t (*hash_function)(const T&);///< funzione hash dei valori
+
+    private:
+        std::vector<unsigned char> _counters;///< contatori (numero potenza di due)
+        std::size_t _mask;///< _counters.size() - 1
+        unsigned int _hashes;///< numero di contatori per valore
+        std::size_t _capacity;///< numero di valori per cui è stato dimensionato
+        double _fp_rate;///< probabilità di falso positivo alla capacità
+        hash_function _hash;///< funzione hash dei valori
+        mutable std::atomic<std::size_t> _lookups;///< vedi filter_stats
+        mutable std::atomic<std::size_t> _filtered;///< vedi filter_stats
+        mutable std::atomic<std::size_t> _false_positives;///< vedi filter_stats
+
+        /**
+         * @brief Rimescola i bit dell'hash (finalizzatore di splitmix64), così anche
+         * funzioni hash banali come std::hash<int> riempiono tutto il filtro
+         */
+        static std::uint64_t mix(std::uint64_t h){
+            h ^= h >> 30;
+            h *= 0xbf58476d1ce4e5b9ULL;
+            h ^= h >> 27;
+            h *= 0x94d049bb133111ebULL;
+            h ^= h >> 31;
+            return h;
+        }
+
+        /**
+         * @brief Incrementa di uno un contatore senza sincronizzazione: i contatori
+         * statistici possono perdere incrementi con ricerche concorrenti
+         */
+        static void bump(std::atomic<std::size_t> &counter){
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+    public:
+        /**
+         * @brief Costruttore
+         *
+         * @param capacity numero di valori previsto
+         * @param fp_rate probabilità di falso positivo con capacity valori (tra 0 e 1)
+         * @param hash funzione hash dei valori
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione dei contatori
+         */
+        counting_bloom_filter(std::size_t capacity, double fp_rate, hash_function hash)
+            : _mask(0), _hashes(1), _capacity(capacity == 0 ? 1 : capacity), _fp_rate(fp_rate), _hash(hash),
+              _lookups(0), _filtered(0), _false_positives(0){
+            const double ln2 = std::log(2.0);
+            if(!(_fp_rate > 0 && _fp_rate < 1))
+                _fp_rate = 0.01;
+            double bits = std::ceil(-static_cast<double>(_capacity) * std::log(_fp_rate) / (ln2 * ln2));
+            std::size_t size = 64;
+            while(size < bits)
+                size <<= 1;
+            _counters.assign(size, 0);
+            _mask = size - 1;
+            _hashes = static_cast<unsigned int>(std::ceil(static_cast<double>(size) / _capacity * ln2));
+            if(_hashes < 1)
+                _hashes = 1;
+            if(_hashes > 16)
+                _hashes = 16;
+        }
+
+        /**
+         * @brief Copy constructor
+         *
+         * @param other filtro da copiare
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione dei contatori
+         */
+        counting_bloom_filter(const counting_bloom_filter &other)
+            : _counters(other._counters), _mask(other._mask), _hashes(other._hashes), _capacity(other._capacity),
+              _fp_rate(other._fp_rate), _hash(other._hash), _lookups(other._lookups.load()),
+              _filtered(other._filtered.load()), _false_positives(other._false_positives.load()){}
+
+        /**
+         * @brief Aggiunge un valore al filtro
+         *
+         * @param value valore da aggiungere
+         */
+        void insert(const T &value){
+            std::uint64_t h = mix(_hash(value));
+            std::uint64_t step = (h >> 32) | 1;
+            for(unsigned int i = 0; i < _hashes; ++i, h += step){
+                unsigned char &c = _counters[h & _mask];
+                if(c != 255)
+                    ++c;
+            }
+        }
+
+        /**
+         * @brief Rimuove dal filtro un valore aggiunto in precedenza
+         *
+         * @param value valore da rimuovere
+         */
+        void erase(const T &value){
+            std::uint64_t h = mix(_hash(value));
+            std::uint64_t step = (h >> 32) | 1;
+            for(unsigned int i = 0; i < _hashes; ++i, h += step){
+                unsigned char &c = _counters[h & _mask];
+                if(c != 255 && c != 0)
+                    --c;
+            }
+        }
+
+        /**
+         * @brief Verifica se un valore può essere presente e aggiorna le statistiche
+         *
+         * @param value valore da cercare
+         * @return false se il valore è sicuramente assente
+         * @return true se il valore è probabilmente presente
+         */
+        bool may_contain(const T &value) const{
+            bump(_lookups);
+            std::uint64_t h = mix(_hash(value));
+            std::uint64_t step = (h >> 32) | 1;
+            for(unsigned int i = 0; i < _hashes; ++i, h += step){
+                if(_counters[h & _mask] == 0){
+                    bump(_filtered);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Registra l'esito della ricerca nell'albero dopo che may_contain ha ritornato true
+         *
+         * @param found true se il valore era presente
+         */
+        void record(bool found) const{
+            if(!found)
+                bump(_false_positives);
+        }
+
+        /**
+         * @brief Svuota il filtro mantenendo dimensione e statistiche
+         *
+         */
+        void clear(){
+            _counters.assign(_counters.size(), 0);
+        }
+
+        /**
+         * @brief Ritorna le statistiche delle ricerche
+         *
+         * @return filter_stats contatori delle ricerche
+         */
+        filter_stats statistics() const{
+            filter_stats stats;
+            stats.lookups = _lookups.load(std::memory_order_relaxed);
+            stats.filtered = _filtered.load(std::memory_order_relaxed);
+            stats.false_positives = _false_positives.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        /**
+         * @brief Ritorna il numero di valori per cui il filtro è stato dimensionato
+         *
+         * @return std::size_t capacità
+         */
+        std::size_t capacity() const{
+            return _capacity;
+        }
+
+        /**
+         * @brief Ritorna la probabilità di falso positivo scelta alla costruzione
+         *
+         * @return double probabilità di falso positivo alla capacità
+         */
+        double false_positive_rate() const{
+            return _fp_rate;
+        }
+
+        /**
+         * @brief Ritorna la funzione hash dei valori
+         *
+         * @return hash_function funzione hash
+         */
+        hash_function hash() const{
+            return _hash;
+        }
+};
+
+#endif
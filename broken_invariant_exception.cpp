@@ -0,0 +1,4 @@
+#include "broken_invariant_exception.h"
+
+broken_invariant_exception::broken_invariant_exception(const std::string &message) 
+    : std::logic_error(message) {}
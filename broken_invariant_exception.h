@@ -0,0 +1,24 @@
+#ifndef BROKEN_INVARIANT_EXCEPTION_H
+#define BROKEN_INVARIANT_EXCEPTION_H
+#include <stdexcept>
+/**
+ * @brief Classe Eccezione
+ * 
+ * La classe implementa un'eccezione lanciata, con la politica di debug
+ * validate_invariants, quando l'albero o i funtori Eql e Comp violano
+ * un invariante
+ * 
+ */
+class broken_invariant_exception : public std::logic_error {
+	
+	public:
+		/**
+		 * @brief Costruttore 
+		 * 
+		 * @param message stringa contenente il messaggio
+		 */
+		broken_invariant_exception(const std::string &message);
+
+};
+
+#endif
\ No newline at end of file
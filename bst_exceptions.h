@@ -0,0 +1,27 @@
+#ifndef BST_EXCEPTIONS_H
+#define BST_EXCEPTIONS_H
+
+/**
+ * Con BST_NO_EXCEPTIONS (definita dall'utente o automaticamente quando si
+ * compila con -fno-exceptions) gli alberi non usano try, catch e throw: gli errori
+ * che lancerebbero un'eccezione terminano il programma con std::abort e le
+ * funzioni try_root e try_add restano il modo per gestirli senza eccezioni
+ */
+#if !defined(BST_NO_EXCEPTIONS) && defined(__GNUC__) && !defined(__EXCEPTIONS)
+#define BST_NO_EXCEPTIONS
+#endif
+
+#ifdef BST_NO_EXCEPTIONS
+#include <cstdlib>
+#define BST_TRY if(true)
+#define BST_CATCH_ALL else
+#define BST_RETHROW ((void)0)
+#define BST_THROW(e) std::abort()
+#else
+#define BST_TRY try
+#define BST_CATCH_ALL catch(...)
+#define BST_RETHROW throw
+#define BST_THROW(e) throw e
+#endif
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef BST_MAP_H
+#define BST_MAP_H
+#include <ostream>
+#include <iterator> // std::forward_iterator_tag
+#include <cstddef>  // std::ptrdiff_t
+#include <utility>  // std::pair, std::forward
+#include "binary_search_tree.h"
+
+/**
+ * @brief Struttura coppia chiave-valore memorizzata nei nodi di bst_map
+ *
+ * La chiave è costante: bst_map::iterator dà accesso in scrittura al valore
+ * senza permettere di alterare l'ordinamento dell'albero
+ *
+ * @tparam K tipo della chiave
+ * @tparam V tipo del valore
+ */
+template<typename K, typename V>
+struct map_entry{
+    const K key;///< chiave
+    V value;///< valore associato alla chiave
+
+    /**
+     * @brief Costruttore
+     *
+     * @param k chiave
+     * @param v valore
+     */
+    map_entry(const K &k, const V &v): key(k), value(v){}
+
+    /**
+     * @brief Operatore di stream
+     *
+     * @param os stream di output
+     * @param e coppia da spedire sullo stream
+     * @return std::ostream& reference dello stream di output
+     */
+    friend std::ostream& operator<<(std::ostream &os, const map_entry &e){
+        return os<<e.key<<":"<<e.value;
+    }
+};
+
+/**
+ * @brief Byte allocati sullo heap da chiave e valore di una coppia (vedi heap_usage)
+ */
+template<typename K, typename V>
+struct heap_usage<map_entry<K, V> >{
+    static std::size_t bytes(const map_entry<K, V> &e){
+        return heap_usage<K>::bytes(e.key) + heap_usage<V>::bytes(e.value);
+    }
+};
+
+/**
+ * @brief Funtore di uguaglianza tra coppie che confronta solo le chiavi
+ *
+ * @tparam K tipo della chiave
+ * @tparam V tipo del valore
+ * @tparam Eql funtore di uguaglianza tra chiavi
+ */
+template<typename K, typename V, typename Eql>
+struct entry_equals{
+    bool operator()(const map_entry<K, V> &a, const map_entry<K, V> &b) const{
+        return Eql()(a.key, b.key);
+    }
+    bool operator()(const map_entry<K, V> &a, const K &k) const{
+        return Eql()(a.key, k);
+    }
+};
+
+/**
+ * @brief Funtore di comparazione tra coppie che confronta solo le chiavi
+ *
+ * @tparam K tipo della chiave
+ * @tparam V tipo del valore
+ * @tparam Comp funtore di comparazione tra chiavi
+ */
+template<typename K, typename V, typename Comp>
+struct entry_compare{
+    bool operator()(const map_entry<K, V> &a, const map_entry<K, V> &b) const{
+        return Comp()(a.key, b.key);
+    }
+    bool operator()(const K &k, const map_entry<K, V> &b) const{
+        return Comp()(k, b.key);
+    }
+};
+
+/**
+ * @brief Classe bst_map
+ *
+ * Dizionario ordinato che associa a ogni chiave un valore. Usa come motore
+ * binary_search_tree sulle coppie chiave-valore: le ricerche confrontano solo
+ * le chiavi e i valori vengono aggiornati nel nodo, senza reinserimenti
+ *
+ * @tparam K tipo delle chiavi
+ * @tparam V tipo dei valori
+ * @tparam Eql funtore di eguaglianza tra chiavi
+ * @tparam Comp funtore di comparazione tra chiavi
+ */
+template<typename K, typename V, typename Eql, typename Comp>
+class bst_map{
+    public:
+        typedef map_entry<K, V> value_type;
+        typedef binary_search_tree<value_type, entry_equals<K, V, Eql>, entry_compare<K, V, Comp> > tree_type;
+        typedef typename tree_type::const_iterator const_iterator;
+
+        /**
+         * @brief Iteratore che dà accesso in scrittura al valore delle coppie (la
+         * chiave resta costante); si ottiene solo da un dizionario non costante
+         */
+        class iterator{
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef map_entry<K, V>           value_type;
+                typedef std::ptrdiff_t            difference_type;
+                typedef value_type*               pointer;
+                typedef value_type&               reference;
+
+                iterator(){}
+
+                reference operator*() const{
+                    return const_cast<reference>(*_it); // i nodi non sono costanti, lo è solo const_iterator
+                }
+
+                pointer operator->() const{
+                    return &**this;
+                }
+
+                iterator& operator++(){
+                    ++_it;
+                    return *this;
+                }
+
+                iterator operator++(int){
+                    iterator tmp(*this);
+                    ++_it;
+                    return tmp;
+                }
+
+                bool operator==(const iterator &other) const{
+                    return _it == other._it;
+                }
+
+                bool operator!=(const iterator &other) const{
+                    return !(*this == other);
+                }
+
+                /**
+                 * @brief Conversione all'iteratore in sola lettura sulla stessa coppia
+                 */
+                operator const_iterator() const{
+                    return _it;
+                }
+
+            private:
+                friend class bst_map;
+
+                const_iterator _it;///< posizione nell'albero
+
+                explicit iterator(const const_iterator &it): _it(it){}
+        };
+
+    private:
+        typedef typename tree_type::node node;
+
+        tree_type _tree;///< albero delle coppie chiave-valore
+
+    public:
+        /**
+         * @brief Funzione che ritorna il numero delle coppie memorizzate
+         *
+         * @return std::size_t numero delle coppie
+         */
+        std::size_t size() const{
+            return _tree.size();
+        }
+
+        /**
+         * @brief Funzione che calcola la memoria occupata dal dizionario
+         * 
+         * @return memory_stats byte dei nodi, di chiavi e valori e persi dall'allocatore
+         */
+        memory_stats memory_usage() const{
+            return _tree.memory_usage();
+        }
+
+        /**
+         * @brief Funzione che verifica se il dizionario è vuoto
+         *
+         * @return true se il dizionario è vuoto
+         * @return false se il dizionario non è vuoto
+         */
+        bool empty() const{
+            return _tree.empty();
+        }
+
+        /**
+         * @brief Funzione che elimina tutte le coppie
+         *
+         */
+        void clear(){
+            _tree.clear();
+        }
+
+        /**
+         * @brief Funzione che cerca una chiave
+         *
+         * @param key chiave da cercare
+         * @return iterator iteratore alla coppia con la chiave, con il valore modificabile (end() se non presente)
+         */
+        iterator find(const K &key){
+            return iterator(static_cast<const bst_map&>(*this).find(key));
+        }
+
+        /**
+         * @brief Funzione che cerca una chiave in un dizionario costante
+         *
+         * @param key chiave da cercare
+         * @return const_iterator iteratore in sola lettura alla coppia con la chiave (end() se non presente)
+         */
+        const_iterator find(const K &key) const{
+            node* parent;
+            bool left;
+            return _tree.make_iterator(_tree.find_key(key, parent, left));
+        }
+
+        /**
+         * @brief Funzione che verifica se una chiave è presente
+         *
+         * @param key chiave da cercare
+         * @return true se la chiave è presente
+         * @return false se la chiave non è presente
+         */
+        bool contains(const K &key) const{
+            node* parent;
+            bool left;
+            return _tree.find_key(key, parent, left) != nullptr;
+        }
+
+        /**
+         * @brief Funzione che inserisce una coppia se la chiave non è presente
+         *
+         * Se la chiave è già presente non viene costruito nessun valore
+         *
+         * @tparam Args tipi degli argomenti del costruttore di V
+         * @param key chiave
+         * @param args argomenti con cui costruire il valore
+         * @return std::pair<iterator, bool> iteratore alla coppia con la chiave e
+         * true se la coppia è stata inserita, false se la chiave era già presente
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const K &key, Args&&... args){
+            node* parent;
+            bool left;
+            node* n = _tree.find_key(key, parent, left);
+            if(n != nullptr)
+                return std::make_pair(iterator(_tree.make_iterator(n)), false);
+
+            n = _tree.attach(parent, left, value_type(key, V(std::forward<Args>(args)...)));
+            _tree.check_invariants();
+            return std::make_pair(iterator(_tree.make_iterator(n)), true);
+        }
+
+        /**
+         * @brief Funzione che associa un valore a una chiave, inserendo la coppia
+         * se la chiave non è presente o aggiornando il valore nel nodo altrimenti
+         *
+         * @param key chiave
+         * @param value valore da associare
+         * @return std::pair<iterator, bool> iteratore alla coppia con la chiave e
+         * true se la coppia è stata inserita, false se il valore è stato aggiornato
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        std::pair<iterator, bool> insert_or_assign(const K &key, const V &value){
+            node* parent;
+            bool left;
+            node* n = _tree.find_key(key, parent, left);
+            if(n != nullptr){
+                n->value.value = value;
+                return std::make_pair(iterator(_tree.make_iterator(n)), false);
+            }
+
+            n = _tree.attach(parent, left, value_type(key, value));
+            _tree.check_invariants();
+            return std::make_pair(iterator(_tree.make_iterator(n)), true);
+        }
+
+        /**
+         * @brief Operatore di accesso al valore associato a una chiave
+         *
+         * Se la chiave non è presente viene inserita con un valore costruito di default
+         *
+         * @param key chiave
+         * @return V& reference al valore associato alla chiave
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        V& operator[](const K &key){
+            return try_emplace(key).first->value;
+        }
+
+        /**
+         * @brief Iteratore di inizio
+         *
+         * @return iterator
+         */
+        iterator begin(){
+            return iterator(_tree.begin());
+        }
+
+        /**
+         * @brief Iteratore di fine
+         *
+         * @return iterator
+         */
+        iterator end(){
+            return iterator(_tree.end());
+        }
+
+        /**
+         * @brief Iteratore di inizio in sola lettura
+         *
+         * @return const_iterator
+         */
+        const_iterator begin() const{
+            return _tree.begin();
+        }
+
+        /**
+         * @brief Iteratore di fine in sola lettura
+         *
+         * @return const_iterator
+         */
+        const_iterator end() const{
+            return _tree.end();
+        }
+
+        /**
+         * @brief Operatore di stream
+         *
+         * @param os stream di output
+         * @param m dizionario da spedire sullo stream
+         * @return std::ostream& reference dello stream di output
+         */
+        friend std::ostream& operator<<(std::ostream &os, const bst_map &m){
+            return os<<m._tree;
+        }
+};
+
+#endif
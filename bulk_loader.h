@@ -0,0 +1,378 @@
+#ifndef BULK_LOADER_H
+#define BULK_LOADER_H
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <iterator>  // std::make_move_iterator
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>   // std::strtol
+#include <cerrno>
+#include <climits>   // INT_MIN, INT_MAX
+#include <fcntl.h>   // open
+#include <unistd.h>  // read, close
+
+/**
+ * @brief Parser di interi in base 10, uno per riga
+ *
+ * Sono ammessi spazi prima e dopo il numero; le righe con altri caratteri dopo
+ * le cifre o con valori fuori dall'intervallo di int vengono scartate
+ *
+ */
+struct int_parser{
+    static bool blank(char c){
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    bool operator()(const char *first, const char *last, int &out) const{
+        while(first != last && blank(*first))
+            ++first;
+        while(first != last && blank(last[-1]))
+            --last;
+        char digits[32]; // la riga non è terminata da '\0': strtol lavora su una copia
+        std::size_t length = last - first;
+        if(length == 0 || length >= sizeof(digits))
+            return false;
+        std::memcpy(digits, first, length);
+        digits[length] = '\0';
+        const char* d = digits[0] == '-' || digits[0] == '+' ? digits + 1 : digits;
+        if(*d < '0' || *d > '9') // strtol accetterebbe altri spazi prima del numero
+            return false;
+        char* end;
+        errno = 0;
+        long v = std::strtol(digits, &end, 10);
+        if(errno == ERANGE || *end != '\0' || v < INT_MIN || v > INT_MAX)
+            return false;
+        out = static_cast<int>(v);
+        return true;
+    }
+};
+
+/**
+ * @brief Parser di stringhe: ogni riga non vuota diventa un valore
+ *
+ */
+struct string_parser{
+    bool operator()(const char *first, const char *last, std::string &out) const{
+        if(last != first && last[-1] == '\r')
+            --last;
+        if(first == last)
+            return false;
+        out.assign(first, last);
+        return true;
+    }
+};
+
+/**
+ * @brief Parser di punti nel formato "x y": due interi (vedi int_parser)
+ * separati da spazi o tabulazioni
+ *
+ * @tparam Point tipo del punto, costruibile da due int
+ */
+template<typename Point>
+struct point_parser{
+    bool operator()(const char *first, const char *last, Point &out) const{
+        int_parser parse_int;
+        while(first != last && int_parser::blank(*first))
+            ++first;
+        const char* separator = first;
+        while(separator != last && *separator != ' ' && *separator != '\t')
+            ++separator;
+        int x, y;
+        if(separator == last || !parse_int(first, separator, x) || !parse_int(separator + 1, last, y))
+            return false;
+        out = Point(x, y);
+        return true;
+    }
+};
+
+/**
+ * @brief Statistiche di un caricamento, con il tempo speso in ogni stadio
+ *
+ */
+struct load_stats{
+    std::size_t bytes;///< byte letti
+    std::size_t records;///< valori riconosciuti dal parser
+    std::size_t inserted;///< valori aggiunti all'albero
+    double read_seconds;///< tempo dello stadio di lettura
+    double parse_seconds;///< tempo di lavoro dello stadio di parsing, sommato su tutti i thread
+    double merge_seconds;///< tempo dello stadio di ordinamento e inserimento
+
+    load_stats(): bytes(0), records(0), inserted(0), read_seconds(0), parse_seconds(0), merge_seconds(0){}
+};
+
+/**
+ * @brief Classe bulk_loader
+ *
+ * Caricatore a pipeline di valori testuali, uno per riga, in un albero binario di ricerca.
+ * Lo stadio 1 legge blocchi grandi con read() e li taglia sull'ultimo a capo, lo stadio 2
+ * trasforma le righe in valori su più thread tramite il parser, lo stadio 3 inserisce
+ * tutti i valori con add_batch (ordinamento, eliminazione dei duplicati e finger search).
+ * Lettura e parsing procedono in parallelo
+ *
+ * @tparam T tipo dei valori
+ * @tparam Parser funtore bool(const char *first, const char *last, T &out) che
+ * riconosce una riga e ritorna false per le righe da scartare
+ */
+template<typename T, typename Parser>
+class bulk_loader{
+    Parser _parser;///< parser delle righe
+    unsigned int _workers;///< numero dei thread di parsing
+    std::size_t _block_size;///< dimensione dei blocchi letti dallo stadio 1
+
+    /**
+     * @brief Coda limitata di blocchi tra lo stadio di lettura e quello di parsing
+     *
+     */
+    class block_queue{
+        std::deque<std::string> _blocks;///< blocchi in attesa
+        std::size_t _capacity;///< numero massimo di blocchi in attesa
+        bool _closed;///< true quando lo stadio di lettura ha terminato
+        std::mutex _mutex;///< protegge i dati membro
+        std::condition_variable _not_empty;///< segnalata quando arriva un blocco o la coda viene chiusa
+        std::condition_variable _not_full;///< segnalata quando un blocco viene prelevato
+
+        public:
+            explicit block_queue(std::size_t capacity): _capacity(capacity), _closed(false){}
+
+            void push(std::string &block){
+                std::unique_lock<std::mutex> lock(_mutex);
+                while(_blocks.size() >= _capacity)
+                    _not_full.wait(lock);
+                _blocks.push_back(std::string());
+                _blocks.back().swap(block);
+                _not_empty.notify_one();
+            }
+
+            bool pop(std::string &block){
+                std::unique_lock<std::mutex> lock(_mutex);
+                while(_blocks.empty() && !_closed)
+                    _not_empty.wait(lock);
+                if(_blocks.empty())
+                    return false;
+                block.swap(_blocks.front());
+                _blocks.pop_front();
+                _not_full.notify_one();
+                return true;
+            }
+
+            void close(){
+                std::lock_guard<std::mutex> lock(_mutex);
+                _closed = true;
+                _not_empty.notify_all();
+            }
+
+            /**
+             * @brief Chiude la coda scartando i blocchi in attesa, così i thread di
+             * parsing terminano senza elaborarli
+             */
+            void abort(){
+                std::lock_guard<std::mutex> lock(_mutex);
+                _closed = true;
+                _blocks.clear();
+                _not_empty.notify_all();
+                _not_full.notify_all();
+            }
+    };
+
+    /**
+     * @brief Thread dello stadio di parsing: se load termina con un'eccezione il
+     * distruttore interrompe la coda e attende i thread, che altrimenti verrebbero
+     * distrutti ancora attivi (std::terminate)
+     *
+     */
+    class worker_group{
+        std::vector<std::thread> _threads;///< thread avviati
+        block_queue &_queue;///< coda da cui i thread prelevano i blocchi
+
+        worker_group(const worker_group&);
+        worker_group& operator=(const worker_group&);
+
+        public:
+            worker_group(block_queue &queue, unsigned int workers): _queue(queue){
+                _threads.reserve(workers); // push_back non può più fallire dopo la creazione di un thread
+            }
+
+            ~worker_group(){
+                _queue.abort();
+                join();
+            }
+
+            void add(std::thread &&t){
+                _threads.push_back(std::move(t));
+            }
+
+            void join(){
+                for(std::size_t i = 0; i < _threads.size(); ++i)
+                    if(_threads[i].joinable())
+                        _threads[i].join();
+            }
+    };
+
+    /**
+     * @brief Ritorna i secondi trascorsi da start
+     *
+     */
+    static double seconds_since(const std::chrono::steady_clock::time_point &start){
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * @brief Stadio 2: preleva blocchi dalla coda e ne riconosce le righe
+     *
+     * @param queue coda dei blocchi
+     * @param out valori riconosciuti da questo thread
+     * @param busy tempo speso a riconoscere righe
+     * @param error eccezione lanciata dal parser, se presente
+     */
+    void parse_blocks(block_queue &queue, std::vector<T> &out, double &busy, std::exception_ptr &error) const{
+        try{
+            std::string block;
+            T value;
+            while(queue.pop(block)){
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                const char* p = block.data();
+                const char* end = p + block.size();
+                while(p < end){
+                    const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                    if(eol == nullptr)
+                        eol = end;
+                    if(_parser(p, eol, value))
+                        out.push_back(value);
+                    p = eol + 1;
+                }
+                busy += seconds_since(start);
+            }
+        }catch(...){
+            error = std::current_exception();
+            std::string block;
+            while(queue.pop(block)){} // svuota la coda per non bloccare lo stadio di lettura
+        }
+    }
+
+    public:
+        /**
+         * @brief Costruttore
+         *
+         * @param parser parser delle righe
+         * @param workers numero dei thread di parsing (0 per il numero di core disponibili)
+         * @param block_size dimensione in byte dei blocchi letti
+         */
+        explicit bulk_loader(Parser parser = Parser(), unsigned int workers = 0, std::size_t block_size = 1 << 20)
+            : _parser(parser), _workers(workers), _block_size(block_size){
+            if(_workers == 0)
+                _workers = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        /**
+         * @brief Funzione che carica nell'albero i valori letti da un file descriptor
+         *
+         * @tparam Tree tipo dell'albero (con add_batch)
+         * @param fd file descriptor aperto in lettura (ad esempio 0 per lo standard input)
+         * @param tree albero in cui inserire i valori
+         * @return load_stats statistiche del caricamento
+         *
+         * @throw std::runtime_error eccezione lanciata in caso di errore di lettura
+         * @throw std::bad_alloc eccezione durante l'allocazione dei blocchi o dei nodi
+         */
+        template<typename Tree>
+        load_stats load(int fd, Tree &tree) const{
+            load_stats stats;
+            block_queue queue(2 * _workers);
+            std::vector<std::vector<T> > parsed(_workers);
+            std::vector<double> busy(_workers, 0.0);
+            std::vector<std::exception_ptr> errors(_workers);
+            worker_group threads(queue, _workers);
+            for(unsigned int i = 0; i < _workers; ++i)
+                threads.add(std::thread(&bulk_loader::parse_blocks, this, std::ref(queue),
+                                        std::ref(parsed[i]), std::ref(busy[i]), std::ref(errors[i])));
+
+            bool read_error = false;
+            std::string carry;
+            std::vector<char> buffer(_block_size);
+            while(true){
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                ssize_t n = ::read(fd, buffer.data(), buffer.size());
+                stats.read_seconds += seconds_since(start);
+                if(n < 0){
+                    if(errno == EINTR) // interrotta da un segnale prima di leggere: si riprova
+                        continue;
+                    read_error = true;
+                    break;
+                }
+                if(n == 0)
+                    break;
+                stats.bytes += n;
+                const char* data = buffer.data();
+                const char* last_eol = data + n - 1;
+                while(last_eol >= data && *last_eol != '\n')
+                    --last_eol;
+                if(last_eol < data){
+                    carry.append(data, n);
+                    continue;
+                }
+                std::string block;
+                block.swap(carry);
+                block.append(data, last_eol + 1);
+                carry.assign(last_eol + 1, data + n);
+                queue.push(block);
+            }
+            if(!carry.empty())
+                queue.push(carry);
+            queue.close();
+            threads.join();
+
+            if(read_error)
+                throw std::runtime_error("Cannot read the input of the bulk loader");
+            for(unsigned int i = 0; i < _workers; ++i)
+                if(errors[i])
+                    std::rethrow_exception(errors[i]);
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for(unsigned int i = 0; i < _workers; ++i){
+                stats.parse_seconds += busy[i];
+                stats.records += parsed[i].size();
+            }
+            std::vector<T> values;
+            values.reserve(stats.records);
+            for(unsigned int i = 0; i < _workers; ++i){
+                values.insert(values.end(), std::make_move_iterator(parsed[i].begin()), std::make_move_iterator(parsed[i].end()));
+                std::vector<T>().swap(parsed[i]);
+            }
+            stats.inserted = tree.add_batch(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+            stats.merge_seconds = seconds_since(start);
+            return stats;
+        }
+
+        /**
+         * @brief Funzione che carica nell'albero i valori letti da un file
+         *
+         * @param path percorso del file
+         * @param tree albero in cui inserire i valori
+         * @return load_stats statistiche del caricamento
+         *
+         * @throw std::runtime_error eccezione lanciata se il file non può essere aperto o letto
+         */
+        template<typename Tree>
+        load_stats load_file(const std::string &path, Tree &tree) const{
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if(fd < 0)
+                throw std::runtime_error("Cannot open " + path);
+            try{
+                load_stats stats = load(fd, tree);
+                ::close(fd);
+                return stats;
+            }catch(...){
+                ::close(fd);
+                throw;
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,577 @@
+#ifndef DURABLE_TREE_H
+#define DURABLE_TREE_H
+#include <string>
+#include <vector>
+#include <cstring>     // std::memcpy
+#include <cstdint>     // std::uint32_t, std::uint64_t
+#include <stdexcept>
+#include <type_traits>
+#include <cerrno>
+#include <fcntl.h>     // open
+#include <unistd.h>    // read, write, fsync, fdatasync, ftruncate, close
+#include <sys/stat.h>  // mkdir
+#include <cstdio>      // std::rename
+#include "binary_search_tree.h"
+
+/**
+ * @brief Punto di personalizzazione di durable_tree: codifica binaria di un valore
+ * nel journal e negli snapshot
+ *
+ * Di default copia i byte del valore, quindi vale solo per i tipi banalmente
+ * copiabili; va specializzato per i tipi che possiedono memoria dinamica
+ *
+ * @tparam T tipo degli elementi
+ */
+template<typename T>
+struct journal_codec{
+    static_assert(std::is_trivially_copyable<T>::value, "journal_codec must be specialized for this type");
+
+    static void encode(const T &value, std::string &out){
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static bool decode(const char* &first, const char *last, T &out){
+        if(static_cast<std::size_t>(last - first) < sizeof(T))
+            return false;
+        std::memcpy(&out, first, sizeof(T));
+        first += sizeof(T);
+        return true;
+    }
+};
+
+/**
+ * @brief Codifica di una stringa: lunghezza su 8 byte seguita dai caratteri
+ */
+template<typename C, typename Tr, typename A>
+struct journal_codec<std::basic_string<C, Tr, A> >{
+    static void encode(const std::basic_string<C, Tr, A> &value, std::string &out){
+        std::uint64_t length = value.size();
+        out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.append(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(C));
+    }
+
+    static bool decode(const char* &first, const char *last, std::basic_string<C, Tr, A> &out){
+        std::uint64_t length;
+        if(static_cast<std::size_t>(last - first) < sizeof(length))
+            return false;
+        std::memcpy(&length, first, sizeof(length));
+        if((static_cast<std::size_t>(last - first) - sizeof(length)) / sizeof(C) < length)
+            return false;
+        first += sizeof(length);
+        out.resize(length);
+        if(length != 0)
+            std::memcpy(&out[0], first, length * sizeof(C));
+        first += length * sizeof(C);
+        return true;
+    }
+};
+
+/**
+ * @brief Statistiche del ripristino eseguito all'apertura di un durable_tree
+ */
+struct recovery_stats{
+    std::size_t snapshot_values;///< valori caricati dallo snapshot
+    std::size_t journal_records;///< operazioni del journal applicate dopo lo snapshot
+    std::size_t discarded_bytes;///< byte in coda al journal scartati perché scritti a metà
+
+    recovery_stats(): snapshot_values(0), journal_records(0), discarded_bytes(0){}
+};
+
+/**
+ * @brief Classe durable_tree
+ *
+ * Albero binario di ricerca persistente su una cartella locale. Ogni add e remove
+ * viene prima codificato in un journal in sola aggiunta e poi applicato
+ * all'albero in memoria. I record vengono scritti e resi persistenti con
+ * fdatasync a gruppi di group_size operazioni (group commit), oppure subito con
+ * sync(): dopo un crash si perdono al più le operazioni dell'ultimo gruppo.
+ * Quando il journal supera la dimensione dell'ultimo snapshot (e almeno
+ * checkpoint_bytes) tutto l'albero viene scritto in un nuovo snapshot binario
+ * ordinato e il journal riparte vuoto, così il ripristino costa O(n) e il
+ * journal resta proporzionale all'albero.
+ *
+ * All'apertura lo snapshot viene caricato con add_batch, che da valori ordinati
+ * costruisce direttamente un albero bilanciato, e poi vengono applicate le
+ * operazioni del journal successive. Snapshot e journal portano un numero di
+ * generazione, così un journal già incluso in uno snapshot non viene riapplicato.
+ * Non è thread-safe
+ *
+ * @tparam T tipo dei valori (con journal_codec)
+ * @tparam Eql funtore di eguaglianza
+ * @tparam Comp funtore di comparazione
+ * @tparam Policy politiche dell'albero (vedi tree_policy)
+ */
+template<typename T, typename Eql, typename Comp, typename Policy = tree_policy>
+class durable_tree{
+    public:
+        typedef binary_search_tree<T, Eql, Comp, Policy> tree_type;///< tipo dell'albero in memoria
+
+    private:
+        /**
+         * @brief Operazioni registrate nel journal
+         */
+        enum journal_op{
+            op_add = 'a',///< add o try_add di un valore
+            op_remove = 'r',///< remove di un valore con tutte le copie
+            op_remove_one = 'o'///< remove_one di un valore
+        };
+
+        tree_type _tree;///< albero in memoria
+        std::string _dir;///< cartella di journal e snapshot
+        int _journal;///< file descriptor del journal, aperto in append
+        std::string _pending;///< record codificati non ancora scritti
+        std::size_t _pending_ops;///< operazioni in _pending
+        std::size_t _group_size;///< operazioni per ogni scrittura e fdatasync
+        std::size_t _journal_bytes;///< dimensione del journal su disco
+        std::size_t _snapshot_bytes;///< dimensione dell'ultimo snapshot
+        std::size_t _checkpoint_bytes;///< dimensione minima del journal per un checkpoint automatico
+        std::uint64_t _generation;///< generazione dello snapshot corrente
+        recovery_stats _recovery;///< esito del ripristino
+
+        static const std::uint32_t journal_magic = 0x4a545342;///< "BSTJ"
+        static const std::uint32_t snapshot_magic = 0x53545342;///< "BSTS"
+        static const std::size_t journal_header = 12;///< magic e generazione
+        static const std::size_t record_header = 8;///< lunghezza e checksum
+
+        /**
+         * @brief Checksum FNV-1a a 32 bit, per riconoscere i record scritti a metà
+         */
+        static std::uint32_t checksum(const char *first, const char *last){
+            std::uint32_t h = 2166136261u;
+            for(; first != last; ++first)
+                h = (h ^ static_cast<unsigned char>(*first)) * 16777619u;
+            return h;
+        }
+
+        template<typename U>
+        static void put(std::string &out, U value){
+            out.append(reinterpret_cast<const char*>(&value), sizeof(U));
+        }
+
+        template<typename U>
+        static bool get(const char* &first, const char *last, U &value){
+            if(static_cast<std::size_t>(last - first) < sizeof(U))
+                return false;
+            std::memcpy(&value, first, sizeof(U));
+            first += sizeof(U);
+            return true;
+        }
+
+        std::string path(const char *name) const{
+            return _dir + "/" + name;
+        }
+
+        static void fail(const std::string &what){
+            throw std::runtime_error(what + ": " + std::strerror(errno));
+        }
+
+        /**
+         * @brief Funzione che legge un file intero (stringa vuota se non esiste)
+         *
+         * @throw std::runtime_error eccezione lanciata in caso di errore di lettura
+         */
+        static std::string read_file(const std::string &file){
+            std::string data;
+            int fd = ::open(file.c_str(), O_RDONLY);
+            if(fd < 0){
+                if(errno == ENOENT)
+                    return data;
+                fail("Cannot open " + file);
+            }
+            char buffer[1 << 16];
+            ssize_t n;
+            while((n = ::read(fd, buffer, sizeof(buffer))) != 0){
+                if(n > 0)
+                    data.append(buffer, n);
+                else if(errno != EINTR)
+                    break;
+            }
+            ::close(fd);
+            if(n < 0)
+                fail("Cannot read " + file);
+            return data;
+        }
+
+        /**
+         * @brief Funzione che scrive tutti i byte su un file descriptor
+         *
+         * @throw std::runtime_error eccezione lanciata in caso di errore di scrittura
+         */
+        static void write_all(int fd, const char *data, std::size_t size, const std::string &file){
+            while(size > 0){
+                ssize_t n = ::write(fd, data, size);
+                if(n < 0){
+                    if(errno == EINTR)
+                        continue;
+                    fail("Cannot write " + file);
+                }
+                data += n;
+                size -= n;
+            }
+        }
+
+        /**
+         * @brief Funzione che scrive un file nuovo in modo atomico: scrittura su un
+         * file temporaneo, fsync, rename e fsync della cartella
+         *
+         * @throw std::runtime_error eccezione lanciata in caso di errore di scrittura
+         */
+        void replace_file(const char *name, const std::string &data) const{
+            std::string tmp = path(name) + ".tmp";
+            int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if(fd < 0)
+                fail("Cannot create " + tmp);
+            try{
+                write_all(fd, data.data(), data.size(), tmp);
+                if(::fsync(fd) != 0)
+                    fail("Cannot sync " + tmp);
+            }catch(...){
+                ::close(fd);
+                throw;
+            }
+            ::close(fd);
+            if(std::rename(tmp.c_str(), path(name).c_str()) != 0)
+                fail("Cannot rename " + tmp);
+            int dir = ::open(_dir.c_str(), O_RDONLY);
+            if(dir >= 0){
+                ::fsync(dir);
+                ::close(dir);
+            }
+        }
+
+        /**
+         * @brief Funzione che apre il journal in append
+         *
+         * @throw std::runtime_error eccezione lanciata se il journal non può essere aperto
+         */
+        void open_journal(){
+            _journal = ::open(path("journal").c_str(), O_WRONLY | O_APPEND);
+            if(_journal < 0)
+                fail("Cannot open " + path("journal"));
+        }
+
+        /**
+         * @brief Funzione che sostituisce il journal con uno vuoto della generazione corrente
+         */
+        void reset_journal(){
+            std::string header;
+            put(header, journal_magic);
+            put(header, _generation);
+            if(_journal >= 0)
+                ::close(_journal);
+            _journal = -1;
+            replace_file("journal", header);
+            open_journal();
+            _journal_bytes = header.size();
+        }
+
+        /**
+         * @brief Funzione che codifica un'operazione in coda a _pending
+         *
+         * @return std::size_t dimensione di _pending prima del record, per annullarlo
+         */
+        std::size_t append_record(journal_op op, const T &value){
+            std::size_t start = _pending.size();
+            _pending.append(record_header, '\0');
+            _pending.push_back(static_cast<char>(op));
+            journal_codec<T>::encode(value, _pending);
+            std::uint32_t length = static_cast<std::uint32_t>(_pending.size() - start - record_header);
+            std::uint32_t sum = checksum(&_pending[start + record_header], &_pending[0] + _pending.size());
+            std::memcpy(&_pending[start], &length, sizeof(length));
+            std::memcpy(&_pending[start + 4], &sum, sizeof(sum));
+            return start;
+        }
+
+        /**
+         * @brief Funzione chiamata dopo ogni operazione registrata: chiude il gruppo
+         * quando è pieno ed esegue il checkpoint quando il journal è cresciuto
+         */
+        void commit(){
+            if(++_pending_ops >= _group_size)
+                sync();
+            if(_journal_bytes >= _checkpoint_bytes && _journal_bytes >= _snapshot_bytes)
+                checkpoint();
+        }
+
+        /**
+         * @brief Funzione che applica all'albero un'operazione letta dal journal
+         */
+        void apply(char op, const T &value){
+            if(op == op_add)
+                _tree.try_add(value);
+            else if(op == op_remove)
+                _tree.remove(value);
+            else if(op == op_remove_one)
+                _tree.remove_one(value);
+        }
+
+        /**
+         * @brief Funzione che carica lo snapshot e applica il journal
+         *
+         * @throw std::runtime_error eccezione lanciata se lo snapshot è danneggiato o illeggibile
+         */
+        void recover(){
+            std::string snapshot = read_file(path("snapshot"));
+            _snapshot_bytes = snapshot.size();
+            if(!snapshot.empty()){
+                const char* p = snapshot.data();
+                const char* end = p + snapshot.size();
+                std::uint32_t magic, sum;
+                std::uint64_t count;
+                if(snapshot.size() < 24 || !get(p, end, magic) || magic != snapshot_magic)
+                    throw std::runtime_error("Corrupted snapshot " + path("snapshot"));
+                get(p, end, _generation);
+                get(p, end, count);
+                end -= sizeof(sum);
+                std::memcpy(&sum, end, sizeof(sum));
+                if(checksum(p, end) != sum)
+                    throw std::runtime_error("Corrupted snapshot " + path("snapshot"));
+                std::vector<T> values;
+                T value;
+                for(std::uint64_t i = 0; i < count; ++i){
+                    std::uint64_t copies;
+                    if(!get(p, end, copies) || !journal_codec<T>::decode(p, end, value))
+                        throw std::runtime_error("Corrupted snapshot " + path("snapshot"));
+                    values.insert(values.end(), copies, value);
+                }
+                _tree.add_batch(values.begin(), values.end());
+                _recovery.snapshot_values = values.size();
+            }
+
+            std::string journal = read_file(path("journal"));
+            const char* p = journal.data();
+            const char* end = p + journal.size();
+            std::uint32_t magic;
+            std::uint64_t generation;
+            if(!get(p, end, magic) || magic != journal_magic || !get(p, end, generation) || generation != _generation){
+                reset_journal(); // journal assente o già incluso nello snapshot
+                return;
+            }
+            const char* valid = p;
+            T value;
+            while(true){
+                std::uint32_t length, sum;
+                if(!get(p, end, length) || !get(p, end, sum) || static_cast<std::size_t>(end - p) < length
+                   || length == 0 || checksum(p, p + length) != sum)
+                    break;
+                const char* record = p + 1;
+                if(!journal_codec<T>::decode(record, p + length, value))
+                    break;
+                apply(*p, value);
+                ++_recovery.journal_records;
+                p += length;
+                valid = p;
+            }
+            _journal_bytes = valid - journal.data();
+            _recovery.discarded_bytes = journal.size() - _journal_bytes;
+            if(_recovery.discarded_bytes != 0 && ::truncate(path("journal").c_str(), _journal_bytes) != 0)
+                fail("Cannot truncate " + path("journal"));
+            open_journal();
+        }
+
+    public:
+        /**
+         * @brief Costruttore: apre (o crea) la cartella e ripristina l'albero
+         *
+         * @param dir cartella di journal e snapshot
+         * @param group_size numero di operazioni scritte e rese persistenti insieme (1 per ogni operazione)
+         * @param checkpoint_bytes dimensione minima del journal oltre la quale viene eseguito un checkpoint
+         *
+         * @throw std::runtime_error eccezione lanciata se i file non possono essere letti o scritti
+         * @throw std::bad_alloc eccezione durante l'allocazione dei nodi
+         */
+        explicit durable_tree(const std::string &dir, std::size_t group_size = 64, std::size_t checkpoint_bytes = 1 << 20)
+            : _dir(dir), _journal(-1), _pending_ops(0), _group_size(group_size == 0 ? 1 : group_size),
+              _journal_bytes(0), _snapshot_bytes(0), _checkpoint_bytes(checkpoint_bytes), _generation(0){
+            if(::mkdir(_dir.c_str(), 0755) != 0 && errno != EEXIST)
+                fail("Cannot create " + _dir);
+            recover();
+        }
+
+        durable_tree(const durable_tree &other) = delete;
+        durable_tree& operator=(const durable_tree &other) = delete;
+
+        /**
+         * @brief Distruttore: rende persistenti le operazioni in sospeso
+         *
+         * Gli errori di scrittura vengono ignorati: per gestirli chiamare sync() prima
+         */
+        ~durable_tree(){
+            try{
+                sync();
+            }catch(...){}
+            if(_journal >= 0)
+                ::close(_journal);
+        }
+
+        /**
+         * @brief Funzione che aggiunge un valore
+         *
+         * @param value valore da aggiungere
+         *
+         * @throw existing_node_exception eccezione lanciata se il valore già esiste (solo unique_keys)
+         * @throw std::runtime_error eccezione lanciata in caso di errore di scrittura del journal
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        void add(const T &value){
+            std::size_t start = append_record(op_add, value);
+            try{
+                _tree.add(value);
+            }catch(...){
+                _pending.resize(start);
+                throw;
+            }
+            commit();
+        }
+
+        /**
+         * @brief Funzione che aggiunge un valore senza lanciare eccezioni per i valori
+         * già presenti; i duplicati ignorati non vengono registrati
+         *
+         * @param value valore da aggiungere
+         * @return typename tree_type::add_result esito dell'inserimento
+         *
+         * @throw std::runtime_error eccezione lanciata in caso di errore di scrittura del journal
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        typename tree_type::add_result try_add(const T &value){
+            std::size_t start = append_record(op_add, value);
+            typename tree_type::add_result result;
+            try{
+                result = _tree.try_add(value);
+            }catch(...){
+                _pending.resize(start);
+                throw;
+            }
+            if(result == tree_type::add_duplicate)
+                _pending.resize(start);
+            else
+                commit();
+            return result;
+        }
+
+        /**
+         * @brief Funzione che rimuove un valore con tutte le sue copie
+         *
+         * @param value valore da rimuovere
+         * @return true se il valore era presente ed è stato rimosso
+         * @return false se il valore non era presente
+         *
+         * @throw std::runtime_error eccezione lanciata in caso di errore di scrittura del journal
+         */
+        bool remove(const T &value){
+            std::size_t start = append_record(op_remove, value);
+            if(!_tree.remove(value)){
+                _pending.resize(start);
+                return false;
+            }
+            commit();
+            return true;
+        }
+
+        /**
+         * @brief Funzione che rimuove una copia di un valore (vedi binary_search_tree::remove_one)
+         *
+         * @param value valore da rimuovere
+         * @return true se il valore era presente
+         * @return false se il valore non era presente
+         *
+         * @throw std::runtime_error eccezione lanciata in caso di errore di scrittura del journal
+         */
+        bool remove_one(const T &value){
+            std::size_t start = append_record(op_remove_one, value);
+            if(!_tree.remove_one(value)){
+                _pending.resize(start);
+                return false;
+            }
+            commit();
+            return true;
+        }
+
+        /**
+         * @brief Funzione che scrive le operazioni in sospeso e attende che siano su disco
+         *
+         * Se la scrittura fallisce le operazioni restano in sospeso e il journal viene
+         * riportato alla dimensione precedente, così un nuovo sync() non duplica i
+         * record già scritti in parte
+         *
+         * @throw std::runtime_error eccezione lanciata in caso di errore di scrittura
+         */
+        void sync(){
+            if(_pending.empty())
+                return;
+            try{
+                if(_journal < 0)
+                    throw std::runtime_error("Cannot write " + path("journal") + ": journal closed after a failed write");
+                write_all(_journal, _pending.data(), _pending.size(), path("journal"));
+                if(::fdatasync(_journal) != 0)
+                    fail("Cannot sync " + path("journal"));
+            }catch(...){
+                if(_journal >= 0 && ::ftruncate(_journal, _journal_bytes) != 0){
+                    // coda del journal sconosciuta: i record successivi verrebbero scritti
+                    // dopo un record incompleto, il recupero la scarterà alla riapertura
+                    ::close(_journal);
+                    _journal = -1;
+                }
+                throw;
+            }
+            _journal_bytes += _pending.size();
+            _pending.clear();
+            _pending_ops = 0;
+        }
+
+        /**
+         * @brief Funzione che scrive tutto l'albero in un nuovo snapshot e svuota il journal
+         *
+         * Lo snapshot viene scritto su un file temporaneo e rinominato, quindi un
+         * crash durante il checkpoint lascia in uso lo snapshot precedente e il suo journal
+         *
+         * @throw std::runtime_error eccezione lanciata in caso di errore di scrittura
+         */
+        void checkpoint(){
+            std::string snapshot;
+            put(snapshot, snapshot_magic);
+            put(snapshot, _generation + 1);
+            put(snapshot, static_cast<std::uint64_t>(_tree.size()));
+            std::size_t body = snapshot.size();
+            for(typename tree_type::const_iterator b = _tree.begin(), e = _tree.end(); b != e; ++b){
+                put(snapshot, static_cast<std::uint64_t>(_tree.count(*b)));
+                journal_codec<T>::encode(*b, snapshot);
+            }
+            put(snapshot, checksum(snapshot.data() + body, snapshot.data() + snapshot.size()));
+            replace_file("snapshot", snapshot);
+            ++_generation;
+            _snapshot_bytes = snapshot.size();
+            _pending.clear();
+            _pending_ops = 0;
+            reset_journal();
+        }
+
+        /**
+         * @brief Funzione che ritorna l'albero in memoria, in sola lettura
+         *
+         * @return const tree_type& albero con tutte le operazioni eseguite
+         */
+        const tree_type& tree() const{
+            return _tree;
+        }
+
+        bool contains(const T &value) const{
+            return _tree.contains(value);
+        }
+
+        std::size_t size() const{
+            return _tree.size();
+        }
+
+        /**
+         * @brief Funzione che ritorna l'esito del ripristino eseguito dal costruttore
+         *
+         * @return const recovery_stats& statistiche del ripristino
+         */
+        const recovery_stats& recovery() const{
+            return _recovery;
+        }
+};
+
+#endif
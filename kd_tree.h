@@ -0,0 +1,609 @@
+#ifndef KD_TREE_H
+#define KD_TREE_H
+#include <algorithm>
+#include <ostream>
+#include <iterator>    // std::forward_iterator_tag
+#include <cstddef>     // std::ptrdiff_t, std::size_t
+#include <cmath>       // std::log
+#include <vector>
+#include <utility>     // std::pair, std::swap, std::declval
+#include <type_traits> // std::decay
+#include "existing_node_exception.h"
+#include "bst_exceptions.h"
+
+/**
+ * @brief Classe kd_tree
+ *
+ * Indice spaziale per chiavi a due dimensioni. Ogni livello divide il piano
+ * alternando l'asse x (livelli pari) e l'asse y (livelli dispari): le chiavi che
+ * precedono il nodo sull'asse del livello stanno a sinistra, le altre a destra.
+ * A parità di coordinata decide l'altro asse, così anche molte chiavi allineate
+ * vengono divise a metà. Quando un inserimento scende oltre log_{3/2}(n) livelli il
+ * sotto-albero sbilanciato più alto viene ricostruito sulle mediane (come negli
+ * alberi scapegoat), così l'altezza resta logaritmica anche per inserimenti ordinati,
+ * le ricerche per rettangolo costano O(sqrt(n) + k) e quelle dei vicini più
+ * prossimi visitano solo le regioni che possono migliorare il risultato
+ *
+ * @tparam T tipo delle chiavi
+ * @tparam Eql funtore di eguaglianza
+ * @tparam Axis funtore che ritorna la coordinata di una chiave su un asse (0 per x, 1 per y)
+ */
+template<typename T, typename Eql, typename Axis>
+class kd_tree{
+    public:
+        typedef typename std::decay<decltype(std::declval<const Axis&>()(std::declval<const T&>(), 0u))>::type coordinate_type;
+
+    private:
+        /**
+         * @brief Struttura nodo
+         */
+        struct node{
+            T value;///< chiave memorizzata
+            node* parent;///< puntatore al nodo padre
+            node* left;///< sotto-albero delle chiavi che precedono il nodo sull'asse del livello
+            node* right;///< sotto-albero delle chiavi che seguono il nodo sull'asse del livello
+
+            /**
+             * @brief Costruttore
+             *
+             * @param v chiave da memorizzare
+             * @param p puntatore al nodo padre
+             */
+            node(const T &v, node *p): value(v), parent(p), left(nullptr), right(nullptr){}
+        };
+
+        /**
+         * @brief Funtore che ordina i nodi su un asse (vedi before)
+         */
+        struct axis_less{
+            const kd_tree* tree;///< albero che fornisce il funtore Axis
+            unsigned int axis;///< asse su cui confrontare
+
+            bool operator()(const node *a, const node *b) const{
+                return tree->before(a->value, b->value, axis);
+            }
+        };
+
+        node* _root;///< puntatore alla radice dell'albero
+        std::size_t _size;///< numero di chiavi memorizzate
+        Eql _equals;///< funtore di uguaglianza
+        Axis _axis;///< funtore delle coordinate
+
+        /**
+         * @brief Funzione che ritorna la coordinata di una chiave su un asse
+         *
+         * @param value chiave
+         * @param axis asse (0 per x, 1 per y)
+         * @return coordinate_type coordinata
+         */
+        coordinate_type coordinate(const T &value, unsigned int axis) const{
+            return _axis(value, axis);
+        }
+
+        /**
+         * @brief Funzione che verifica se una chiave precede un'altra su un asse:
+         * confronta le coordinate sull'asse e, se uguali, quelle sull'altro asse
+         *
+         * @param a prima chiave
+         * @param b seconda chiave
+         * @param axis asse del livello
+         * @return true se a va nel sotto-albero sinistro di un nodo che contiene b
+         */
+        bool before(const T &a, const T &b, unsigned int axis) const{
+            coordinate_type ca = coordinate(a, axis);
+            coordinate_type cb = coordinate(b, axis);
+            if(ca < cb)
+                return true;
+            if(cb < ca)
+                return false;
+            return coordinate(a, 1 - axis) < coordinate(b, 1 - axis);
+        }
+
+        /**
+         * @brief Funzione che copia un sotto-albero
+         *
+         * @param root radice del sotto-albero
+         * @param parent nodo padre della copia
+         * @return node* radice della copia
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo (i nodi già copiati vengono rimossi)
+         */
+        static node* copy(const node *root, node *parent){
+            if(root == nullptr)
+                return nullptr;
+            node* clone = new node(root->value, parent);
+            BST_TRY{
+                clone->left = copy(root->left, clone);
+                clone->right = copy(root->right, clone);
+            }BST_CATCH_ALL{
+                erase(clone);
+                BST_RETHROW;
+            }
+            return clone;
+        }
+
+        /**
+         * @brief Funzione che dealloca un sotto-albero
+         *
+         * @param root radice del sotto-albero
+         */
+        static void erase(node *root){
+            if(root == nullptr)
+                return;
+            erase(root->left);
+            erase(root->right);
+            delete root;
+        }
+
+        /**
+         * @brief Funzione che conta i nodi di un sotto-albero
+         *
+         * @param root radice del sotto-albero
+         * @return std::size_t numero dei nodi
+         */
+        static std::size_t count_node(const node *root){
+            if(root == nullptr)
+                return 0;
+            return count_node(root->left) + count_node(root->right) + 1;
+        }
+
+        /**
+         * @brief Funzione che raccoglie in ordine i nodi di un sotto-albero
+         *
+         * @param root radice del sotto-albero
+         * @param out vettore in cui aggiungere i nodi
+         */
+        static void collect(node *root, std::vector<node*> &out){
+            if(root == nullptr)
+                return;
+            collect(root->left, out);
+            out.push_back(root);
+            collect(root->right, out);
+        }
+
+        /**
+         * @brief Funzione che ritorna il nodo successivo nella visita in ordine
+         *
+         * @param ptr puntatore al nodo
+         * @return const node* nodo successivo (nullptr se ptr è l'ultimo)
+         */
+        static const node* successor(const node *ptr){
+            if(ptr->right != nullptr){
+                ptr = ptr->right;
+                while(ptr->left != nullptr)
+                    ptr = ptr->left;
+                return ptr;
+            }
+            while(ptr->parent != nullptr && ptr == ptr->parent->right)
+                ptr = ptr->parent;
+            return ptr->parent;
+        }
+
+        /**
+         * @brief Funzione che ricollega dei nodi esistenti in un sotto-albero bilanciato
+         *
+         * La radice di ogni livello è la mediana sull'asse del livello
+         *
+         * @param nodes nodi da ricollegare (vengono riordinati)
+         * @param lo indice del primo nodo
+         * @param hi indice successivo all'ultimo nodo
+         * @param depth livello della radice del sotto-albero
+         * @param parent nodo padre della radice
+         * @return node* radice del sotto-albero
+         */
+        node* build(std::vector<node*> &nodes, std::size_t lo, std::size_t hi, unsigned int depth, node *parent){
+            if(lo >= hi)
+                return nullptr;
+
+            axis_less cmp = {this, depth % 2};
+            std::size_t mid = lo + (hi - lo) / 2;
+            std::nth_element(nodes.begin() + lo, nodes.begin() + mid, nodes.begin() + hi, cmp);
+
+            node* root = nodes[mid];
+            root->parent = parent;
+            root->left = build(nodes, lo, mid, depth + 1, root);
+            root->right = build(nodes, mid + 1, hi, depth + 1, root);
+            return root;
+        }
+
+        /**
+         * @brief Funzione che ricostruisce bilanciato il sotto-albero con radice nel nodo passato
+         *
+         * @param root radice del sotto-albero
+         * @param depth livello di root
+         */
+        void rebuild(node *root, unsigned int depth){
+            node* parent = root->parent;
+            std::vector<node*> nodes;
+            collect(root, nodes);
+            node* rebuilt = build(nodes, 0, nodes.size(), depth, parent);
+            if(parent == nullptr)
+                _root = rebuilt;
+            else if(parent->left == root)
+                parent->left = rebuilt;
+            else
+                parent->right = rebuilt;
+        }
+
+        /**
+         * @brief Funzione che ritorna la profondità massima ammessa per n nodi
+         *
+         * @param n numero dei nodi
+         * @return unsigned int log_{3/2}(n)
+         */
+        static unsigned int max_depth(std::size_t n){
+            return static_cast<unsigned int>(std::log(static_cast<double>(n)) / std::log(1.5));
+        }
+
+        /**
+         * @brief Funzione che, dopo un inserimento troppo profondo, risale dal nodo
+         * inserito fino al primo antenato sbilanciato e ne ricostruisce il sotto-albero
+         *
+         * Un antenato è sbilanciato se un figlio contiene più di 2/3 dei suoi nodi
+         *
+         * @param x nodo inserito
+         * @param depth livello di x
+         */
+        void rebalance(node *x, unsigned int depth){
+            std::size_t size = 1;
+            while(x->parent != nullptr){
+                node* p = x->parent;
+                node* sibling = p->left == x ? p->right : p->left;
+                std::size_t parent_size = size + count_node(sibling) + 1;
+                --depth;
+                if(3 * size > 2 * parent_size){
+                    rebuild(p, depth);
+                    return;
+                }
+                size = parent_size;
+                x = p;
+            }
+            rebuild(_root, 0);
+        }
+
+        /**
+         * @brief Funzione che cerca un nodo
+         *
+         * @param value chiave da cercare
+         * @return const node* nodo che contiene la chiave (nullptr se non presente)
+         */
+        const node* find_node(const T &value) const{
+            const node* x = _root;
+            unsigned int depth = 0;
+            while(x != nullptr && !_equals(x->value, value)){
+                x = before(value, x->value, depth % 2) ? x->left : x->right;
+                ++depth;
+            }
+            return x;
+        }
+
+        /**
+         * @brief Funzione che calcola il quadrato della distanza euclidea tra due chiavi
+         *
+         * @return double quadrato della distanza
+         */
+        double distance2(const T &a, const T &b) const{
+            double dx = static_cast<double>(coordinate(a, 0)) - static_cast<double>(coordinate(b, 0));
+            double dy = static_cast<double>(coordinate(a, 1)) - static_cast<double>(coordinate(b, 1));
+            return dx * dx + dy * dy;
+        }
+
+        typedef std::pair<double, const node*> candidate;///< quadrato della distanza dal punto cercato e nodo
+
+        /**
+         * @brief Funzione che cerca i k nodi più vicini a target nel sotto-albero
+         *
+         * Scende prima nel lato che contiene target e visita l'altro lato solo se la
+         * retta di divisione è più vicina del peggiore dei candidati trovati
+         *
+         * @param root radice del sotto-albero
+         * @param depth livello di root
+         * @param target chiave di cui cercare i vicini
+         * @param k numero di vicini
+         * @param heap max-heap dei migliori candidati trovati (al più k)
+         */
+        void nearest(const node *root, unsigned int depth, const T &target, std::size_t k, std::vector<candidate> &heap) const{
+            if(root == nullptr)
+                return;
+
+            double d = distance2(root->value, target);
+            if(heap.size() < k){
+                heap.push_back(candidate(d, root));
+                std::push_heap(heap.begin(), heap.end());
+            }else if(d < heap.front().first){
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = candidate(d, root);
+                std::push_heap(heap.begin(), heap.end());
+            }
+
+            unsigned int axis = depth % 2;
+            double diff = static_cast<double>(coordinate(target, axis)) - static_cast<double>(coordinate(root->value, axis));
+            const node* near_side = diff < 0 ? root->left : root->right;
+            const node* far_side = diff < 0 ? root->right : root->left;
+            nearest(near_side, depth + 1, target, k, heap);
+            if(heap.size() < k || diff * diff < heap.front().first)
+                nearest(far_side, depth + 1, target, k, heap);
+        }
+
+    public:
+        /**
+         * @brief Costruttore di default
+         *
+         * @post _root == nullptr
+         * @post _size == 0
+         */
+        kd_tree(): _root(nullptr), _size(0){}
+
+        /**
+         * @brief Copy constructor
+         *
+         * @param other albero da copiare
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        kd_tree(const kd_tree &other): _root(copy(other._root, nullptr)), _size(other._size){}
+
+        /**
+         * @brief Operatore assegnamento
+         *
+         * @param other albero da copiare
+         * @return kd_tree& riferimento all'albero this
+         */
+        kd_tree& operator=(const kd_tree &other){
+            if(this != &other){
+                kd_tree tmp(other);
+                std::swap(_root, tmp._root);
+                std::swap(_size, tmp._size);
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Distruttore
+         *
+         */
+        ~kd_tree(){
+            clear();
+        }
+
+        /**
+         * @brief Funzione che elimina tutte le chiavi
+         *
+         */
+        void clear(){
+            erase(_root);
+            _root = nullptr;
+            _size = 0;
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero delle chiavi memorizzate
+         *
+         * @return std::size_t numero delle chiavi
+         */
+        std::size_t size() const{
+            return _size;
+        }
+
+        /**
+         * @brief Funzione che verifica se l'albero è vuoto
+         *
+         * @return true se l'albero è vuoto
+         * @return false se l'albero non è vuoto
+         */
+        bool empty() const{
+            return _root == nullptr;
+        }
+
+        /**
+         * @brief Funzione che aggiunge una nuova chiave
+         *
+         * @param value chiave da aggiungere
+         *
+         * @throw existing_node_exception eccezione lanciata se la chiave da aggiungere già esiste
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        void add(const T &value){
+            if(_root == nullptr){
+                _root = new node(value, nullptr);
+                _size = 1;
+                return;
+            }
+
+            node* x = _root;
+            unsigned int depth = 0;
+            while(true){
+                if(_equals(x->value, value))
+                    BST_THROW(existing_node_exception("Cannot insert an existing node in the kd tree"));
+                node* &child = before(value, x->value, depth % 2) ? x->left : x->right;
+                ++depth;
+                if(child == nullptr){
+                    child = new node(value, x);
+                    x = child;
+                    break;
+                }
+                x = child;
+            }
+            ++_size;
+            if(depth > max_depth(_size))
+                rebalance(x, depth);
+        }
+
+        /**
+         * @brief Funzione che verifica se una chiave è presente
+         *
+         * @param value chiave da cercare
+         * @return true se la chiave è presente
+         * @return false se la chiave non è presente
+         */
+        bool contains(const T &value) const{
+            return find_node(value) != nullptr;
+        }
+
+        /**
+         * @brief Funzione che copia in out le chiavi comprese in un rettangolo
+         *
+         * Vengono visitati solo i sotto-alberi la cui regione interseca il rettangolo
+         *
+         * @tparam OutIt tipo dell'iteratore di output
+         * @param low vertice del rettangolo con le coordinate minime (incluso)
+         * @param high vertice del rettangolo con le coordinate massime (incluso)
+         * @param out posizione in cui scrivere le chiavi trovate, in ordine qualsiasi
+         * @return OutIt posizione successiva all'ultima chiave scritta
+         */
+        template<typename OutIt>
+        OutIt range_query(const T &low, const T &high, OutIt out) const{
+            std::vector<std::pair<const node*, unsigned int> > stack;
+            if(_root != nullptr)
+                stack.push_back(std::make_pair(_root, 0u));
+            while(!stack.empty()){
+                const node* n = stack.back().first;
+                unsigned int depth = stack.back().second;
+                stack.pop_back();
+
+                coordinate_type x = coordinate(n->value, 0);
+                coordinate_type y = coordinate(n->value, 1);
+                if(!(x < coordinate(low, 0)) && !(coordinate(high, 0) < x) && !(y < coordinate(low, 1)) && !(coordinate(high, 1) < y)){
+                    *out = n->value;
+                    ++out;
+                }
+                unsigned int axis = depth % 2;
+                coordinate_type split = coordinate(n->value, axis);
+                if(n->left != nullptr && !(split < coordinate(low, axis)))
+                    stack.push_back(std::make_pair(n->left, depth + 1));
+                if(n->right != nullptr && !(coordinate(high, axis) < split))
+                    stack.push_back(std::make_pair(n->right, depth + 1));
+            }
+            return out;
+        }
+
+        /**
+         * @brief Funzione che copia in out le k chiavi più vicine a target
+         * (distanza euclidea), dalla più vicina
+         *
+         * @tparam OutIt tipo dell'iteratore di output
+         * @param target chiave di cui cercare i vicini
+         * @param k numero di vicini
+         * @param out posizione in cui scrivere le chiavi trovate
+         * @return OutIt posizione successiva all'ultima chiave scritta (al più min(k, size()) chiavi)
+         */
+        template<typename OutIt>
+        OutIt nearest(const T &target, std::size_t k, OutIt out) const{
+            if(k == 0)
+                return out;
+            std::vector<candidate> heap;
+            heap.reserve(std::min(k, _size));
+            nearest(_root, 0, target, k, heap);
+            std::sort_heap(heap.begin(), heap.end());
+            for(typename std::vector<candidate>::const_iterator i = heap.begin(); i != heap.end(); ++i){
+                *out = i->second->value;
+                ++out;
+            }
+            return out;
+        }
+
+        /**
+         * @brief Classe const_iterator
+         *
+         * Visita le chiavi in ordine simmetrico dell'albero (non ordinate per coordinata)
+         */
+        class const_iterator{
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T                         value_type;
+                typedef std::ptrdiff_t            difference_type;
+                typedef const T*                  pointer;
+                typedef const T&                  reference;
+
+                /**
+                 * @brief Costruttore di default
+                 *
+                 */
+                const_iterator(): _ptr(nullptr){}
+
+                reference operator*() const{
+                    return _ptr->value;
+                }
+
+                pointer operator->() const{
+                    return &(_ptr->value);
+                }
+
+                const_iterator& operator++(){
+                    _ptr = successor(_ptr);
+                    return *this;
+                }
+
+                const_iterator operator++(int){
+                    const_iterator tmp(*this);
+                    _ptr = successor(_ptr);
+                    return tmp;
+                }
+
+                bool operator==(const const_iterator &other) const{
+                    return _ptr == other._ptr;
+                }
+
+                bool operator!=(const const_iterator &other) const{
+                    return !(*this == other);
+                }
+
+            private:
+                friend class kd_tree;///< friend della classe kd_tree
+                const node* _ptr;///< nodo a cui l'iteratore fa riferimento
+
+                /**
+                 * @brief Costruttore privato
+                 *
+                 * @param n nodo a cui fare riferimento
+                 */
+                explicit const_iterator(const node *n): _ptr(n){}
+        };
+
+        /**
+         * @brief Funzione che cerca una chiave
+         *
+         * @param value chiave da cercare
+         * @return const_iterator iteratore alla chiave (end() se non presente)
+         */
+        const_iterator find(const T &value) const{
+            return const_iterator(find_node(value));
+        }
+
+        /**
+         * @brief Iteratore di inizio
+         *
+         * @return const_iterator
+         */
+        const_iterator begin() const{
+            const node* n = _root;
+            if(n != nullptr)
+                while(n->left != nullptr)
+                    n = n->left;
+            return const_iterator(n);
+        }
+
+        /**
+         * @brief Iteratore di fine
+         *
+         * @return const_iterator
+         */
+        const_iterator end() const{
+            return const_iterator(nullptr);
+        }
+
+        /**
+         * @brief Operatore di stream
+         *
+         * @param os stream di output
+         * @param tree albero da spedire sullo stream
+         * @return std::ostream& reference dello stream di output
+         */
+        friend std::ostream& operator<<(std::ostream &os, const kd_tree &tree){
+            for(const_iterator b = tree.begin(), e = tree.end(); b != e; ++b)
+                os<<*b<<" ";
+            return os;
+        }
+};
+
+#endif
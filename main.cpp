@@ -1,8 +1,27 @@
 #include "binary_search_tree.h"
+#include "tree_views.h"
+#include "bst_map.h"
+#include "tree_export.h"
+#include "bulk_loader.h"
+#include "kd_tree.h"
+#include "radix_tree.h"
+#include "sharded_tree.h"
+#include "durable_tree.h"
+#include "static_tree.h"
+#include <fstream>
+#include <cstdio>
 #include <iostream>
 #include <string>
 #include <cassert>
 #include <math.h>
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/stat.h>
 /**
  * @brief Struttura che implementa un punto 
  * 
@@ -30,13 +49,13 @@ public:
      * 
      * @param other oggetto point da cui copiare i dati
      */
-    point(const point &other) : x(other.x), y(other.y) {}
+    point(const point &other) = default;
     
     /**
      * @brief Distruttore
      * 
      */
-    ~point() {}
+    ~point() = default;
 
     /**
      * @brief Operatore assegnamento
@@ -44,11 +63,7 @@ public:
      * @param other oggetto point da cui copiare i dati
      * @return reference all'oggetto this
      */
-    point &operator=(const point &other) {
-        x = other.x;
-        y = other.y;
-        return *this;
-    }
+    point &operator=(const point &other) = default;
     /**
      * @brief Operatore==
      * 
@@ -148,6 +163,12 @@ struct compare_int{
         return a < b;
     }
 };
+/**
+ * @brief compare_int equivale a operator< sugli interi
+ * 
+ */
+template<>
+struct is_less_comparator<compare_int, int> : std::true_type{};
 /**
  * @brief Funtore predicato di uguaglianza tra due stringhe
  * 
@@ -564,8 +585,1683 @@ void test_const_iterator(){
     e++;
     assert(((int)begin->distance_from(*(e++)))== 4);
 }
+/**
+ * @brief Test sulle ricerche a gruppi
+ * 
+ */
+void test_batch_lookup(){
+    std::cout<<"***** TEST BINARY SEARCH TREE BATCH LOOKUP *****"<<std::endl;
+    binary_search_tree<int, equals_int, compare_int> tree = create_tree_int();
+    std::vector<int> keys;
+    for(int i = -5; i < 40; ++i)
+        keys.push_back(i);
+
+    std::vector<bool> found;
+    tree.contains_batch(keys.begin(), keys.end(), std::back_inserter(found));
+    assert(found.size() == keys.size());
+    for(unsigned int i = 0; i < keys.size(); ++i)
+        assert(found[i] == tree.contains(keys[i]));
+
+    std::vector<binary_search_tree<int, equals_int, compare_int>::const_iterator> it(keys.size());
+    tree.find_batch(keys.begin(), keys.end(), it.begin());
+    for(unsigned int i = 0; i < keys.size(); ++i){
+        if(tree.contains(keys[i]))
+            assert(*it[i] == keys[i]);
+        else
+            assert(it[i] == tree.end());
+    }
+
+    binary_search_tree<std::string, equals_string, compare_string> tree_s = create_tree_string();
+    std::string words[] = {"java", "rust", "c", "sql", "spring"};
+    bool res[5];
+    tree_s.contains_batch(words, words + 5, res);
+    assert(res[0] && !res[1] && res[2] && res[3] && !res[4]);
+
+    binary_search_tree<int, equals_int, compare_int> empty;
+    empty.contains_batch(keys.begin(), keys.end(), found.begin());
+    assert(found[0] == false && found[keys.size() - 1] == false);
+}
+
+/**
+ * @brief Test sull'inserimento a gruppi
+ * 
+ */
+void test_add_batch(){
+    std::cout<<"***** TEST BINARY SEARCH TREE ADD BATCH *****"<<std::endl;
+    binary_search_tree<int, equals_int, compare_int> tree;
+    int values[] = {5, 3, 9, 1, 7, 3, 5, 2, 8, 4, 6};
+    assert(tree.add_batch(values, values + 11) == 9);
+    assert(tree.size() == 9);
+    assert(tree.root() == 5);
+    std::cout<< tree <<std::endl;
+
+    std::vector<int> more;
+    for(int i = 20; i > -5; --i)
+        more.push_back(i);
+    assert(tree.add_batch(more.begin(), more.end()) == 16);
+    assert(tree.size() == 25);
+    int expected = -4;
+    binary_search_tree<int, equals_int, compare_int>::const_iterator b, e;
+    for(b = tree.begin(), e = tree.end(); b != e; ++b, ++expected)
+        assert(*b == expected);
+    assert(expected == 21);
+    assert(tree.add_batch(values, values + 11) == 0);
+    assert(tree.add_batch(values, values) == 0);
+
+    binary_search_tree<std::string, equals_string, compare_string> tree_s = create_tree_string();
+    std::string words[] = {"rust", "java", "ada", "rust", "zig"};
+    assert(tree_s.add_batch(words, words + 5) == 3);
+    assert(tree_s.size() == 17);
+    assert(tree_s.contains("ada") && tree_s.contains("zig"));
+}
+
+/**
+ * @brief Test sulle chiavi piccole e sui funtori equivalenti a operator<
+ * 
+ */
+void test_small_keys(){
+    std::cout<<"***** TEST BINARY SEARCH TREE SMALL KEYS *****"<<std::endl;
+    assert(is_small_key<int>::value);
+    assert(is_small_key<point>::value);
+    assert(!is_small_key<std::string>::value);
+    assert((is_less_comparator<std::less<int>, int>::value));
+    assert((is_less_comparator<compare_int, int>::value));
+    assert((!is_less_comparator<compare_point, point>::value));
+
+    binary_search_tree<int, std::equal_to<int>, std::less<int> > tree;
+    for(int i = 0; i < 10; ++i)
+        tree.add((i * 7) % 10);
+    assert(tree.size() == 10 && tree.root() == 0);
+    for(int i = 0; i < 10; ++i)
+        assert(tree.contains(i));
+    assert(!tree.contains(10) && !tree.contains(-1));
+
+    binary_search_tree<int, std::equal_to<int>, std::less<int> > copy(tree);
+    binary_search_tree<int, std::equal_to<int>, std::less<int> >::const_iterator b = copy.begin();
+    for(int i = 0; i < 10; ++i, ++b)
+        assert(*b == i);
+    assert(b == copy.end());
+
+    binary_search_tree<point, equals_point, compare_point> tree_point = create_tree_point();
+    binary_search_tree<point, equals_point, compare_point> copy_point(tree_point);
+    assert(copy_point.size() == 9);
+    assert(copy_point.contains(point(-4,-1)) && copy_point.contains(point(10,11)));
+}
+
+/**
+ * @brief Test sugli inserimenti e sulle ricerche a partire da un iteratore
+ * 
+ */
+void test_hinted_add(){
+    std::cout<<"***** TEST BINARY SEARCH TREE HINTED ADD *****"<<std::endl;
+    typedef binary_search_tree<int, equals_int, compare_int> int_tree;
+    int_tree tree;
+    int_tree::const_iterator hint = tree.end();
+    for(int i = 0; i < 100000; ++i)
+        hint = tree.add(hint, i);
+    assert(tree.size() == 100000);
+    assert(*hint == 99999);
+    try{
+        tree.add(hint, 500);
+    }catch(const existing_node_exception &e){
+        std::cout<< e.what() << std::endl;
+    }
+
+    int expected = 0;
+    for(int_tree::const_iterator b = tree.begin(), e = tree.end(); b != e; ++b, ++expected)
+        assert(*b == expected);
+    assert(expected == 100000);
+
+    hint = tree.find(50000);
+    assert(*hint == 50000);
+    assert(*tree.find(hint, 50010) == 50010);
+    assert(*tree.find(hint, 49990) == 49990);
+    assert(tree.find(hint, 100000) == tree.end());
+    assert(tree.find(tree.end(), 7) == tree.find(7));
+    tree.clear();
+    assert(tree.empty() && tree.size() == 0);
+
+    int_tree t = create_tree_int();
+    hint = t.find(5);
+    hint = t.add(hint, 10);
+    assert(*hint == 10 && t.size() == 10);
+    hint = t.add(hint, 0);
+    assert(*t.begin() == 0 && t.size() == 11);
+    int_tree other = create_tree_int();
+    hint = t.add(other.find(8), -1);
+    assert(*t.begin() == -1);
+}
+
+/**
+ * @brief Funzione che raddoppia un intero
+ * 
+ */
+int twice(int x){
+    return 2 * x;
+}
+/**
+ * @brief Funzione che somma due interi
+ * 
+ */
+int sum(int a, int b){
+    return a + b;
+}
+/**
+ * @brief Funtore predicato monotono, vero per gli interi minori di una soglia
+ * 
+ */
+struct less_than{
+    int limit;///< soglia
+    bool operator()(int x) const{
+        return x < limit;
+    }
+};
+/**
+ * @brief Test sulle viste pigre
+ * 
+ */
+/**
+ * @brief Direzione letta da compare_int_dir al momento della costruzione
+ * 
+ */
+bool descending_order = false;
+
+/**
+ * @brief Funtore con stato: il verso di ordinamento viene fissato alla costruzione
+ * 
+ */
+struct compare_int_dir{
+    bool descending;
+    compare_int_dir() : descending(descending_order){}
+    bool operator()(int a, int b) const{
+        return descending ? b < a : a < b;
+    }
+};
+
+void test_views(){
+    std::cout<<"***** TEST BINARY SEARCH TREE VIEWS *****"<<std::endl;
+    typedef binary_search_tree<int, equals_int, compare_int> int_tree;
+    int_tree tree = create_tree_int();
+
+    assert(bst_count_if(tree, is_even) == 4);
+    assert(bst_count_if(bst_filter(tree, is_odd), is_even) == 0);
+    assert(bst_accumulate(tree, 0, sum) == 45);
+    assert(bst_accumulate(bst_filter(tree, is_even), 0, sum) == 20);
+    assert(bst_accumulate(bst_transform(bst_filter(tree, is_odd), twice), 0, sum) == 50);
+
+    assert(*tree.lower_bound(5) == 5);
+    assert(tree.lower_bound(10) == tree.end());
+    assert(*tree.lower_bound(-3) == 1);
+    assert(bst_accumulate(bst_range(tree, 3, 7), 0, sum) == 3 + 4 + 5 + 6);
+    assert(bst_count_if(bst_range(tree, 7, 3), is_even) == 0);
+
+    std::cout<<"First 3 odd values: ";
+    bst_iterator_range<bst_take_iterator<bst_filter_iterator<int_tree::const_iterator, bool(*)(int)> > > v = bst_take(bst_filter(tree, is_odd), 3);
+    int expected[] = {1, 3, 5};
+    int i = 0;
+    for(bst_take_iterator<bst_filter_iterator<int_tree::const_iterator, bool(*)(int)> > b = v.begin(); b != v.end(); ++b, ++i){
+        std::cout<< *b <<" ";
+        assert(*b == expected[i]);
+    }
+    std::cout<<std::endl;
+    assert(i == 3);
+    assert(bst_count_if(bst_take(tree, 100), is_even) == 4);
+    assert(bst_count_if(bst_take(tree, 0), is_even) == 0);
+
+    less_than lt = {4};
+    assert(*tree.partition_point(lt) == 4);
+    assert(bst_accumulate(bst_prefix_while(tree, lt), 0, sum) == 6);
+    lt.limit = 100;
+    assert(tree.partition_point(lt) == tree.end());
 
+    binary_search_tree<std::string, equals_string, compare_string> tree_s = create_tree_string();
+    assert(bst_count_if(tree_s, string_starts_with_c) == 3);
+    assert(bst_count_if(bst_filter(tree_s, lenght_equal_4), string_starts_with_c) == 0);
+    assert(bst_count_if(bst_range(tree_s, std::string("c"), std::string("d")), string_starts_with_c) == 3);
 
+    descending_order = true;
+    binary_search_tree<int, equals_int, compare_int_dir> tree_d;
+    for(int k = 1; k <= 8; ++k) tree_d.add(k);
+    descending_order = false;
+    assert(tree_d.key_comp()(7, 3));
+    assert(*tree_d.begin() == 8);
+    assert(bst_accumulate(bst_range(tree_d, 7, 3), 0, sum) == 7 + 6 + 5 + 4);
+    assert(bst_count_if(bst_range(tree_d, 3, 7), is_even) == 0);
+}
+
+/**
+ * @brief Test sul dizionario bst_map
+ * 
+ */
+void test_bst_map(){
+    std::cout<<"***** TEST BST MAP *****"<<std::endl;
+    bst_map<std::string, int, equals_string, compare_string> m;
+    assert(m.empty() && m.size() == 0);
+    m["java"] = 1;
+    m["c++"] = 2;
+    m["php"];
+    assert(m.size() == 3);
+    assert(m["php"] == 0);
+    m["java"] += 10;
+    assert(m.find("java")->value == 11);
+    assert(m.contains("c++") && !m.contains("rust"));
+    assert(m.find("rust") == m.end());
+
+    std::pair<bst_map<std::string, int, equals_string, compare_string>::iterator, bool> r;
+    r = m.try_emplace("c++", 100);
+    assert(!r.second && r.first->value == 2);
+    r = m.try_emplace("go", 5);
+    assert(r.second && r.first->value == 5 && m.size() == 4);
+    r = m.insert_or_assign("go", 6);
+    assert(!r.second && m.find("go")->value == 6);
+    r = m.insert_or_assign("lisp", 7);
+    assert(r.second && m.size() == 5);
+
+    bst_map<std::string, int, equals_string, compare_string>::iterator b = m.begin();
+    b->value = 42;
+    assert(m["c++"] == 42);
+
+    // da un dizionario costante si ottengono solo coppie in sola lettura; la chiave è sempre costante
+    typedef bst_map<std::string, int, equals_string, compare_string> string_map;
+    const string_map &cm = m;
+    string_map::const_iterator c = cm.find("go");
+    static_assert(std::is_same<decltype((c->value)), const int&>::value, "const find gives read-only values");
+    static_assert(std::is_same<decltype((b->key)), const std::string&>::value, "keys are read-only");
+    assert(c->value == 6 && c == string_map::const_iterator(m.find("go")) && cm.find("rust") == cm.end());
+    std::cout<< m <<std::endl;
+
+    std::string expected[] = {"c++", "go", "java", "lisp", "php"};
+    int i = 0;
+    for(b = m.begin(); b != m.end(); ++b, ++i)
+        assert(b->key == expected[i]);
+
+    bst_map<int, std::string, equals_int, compare_int> frequencies;
+    for(int j = 0; j < 20; ++j)
+        frequencies[j % 5] += "x";
+    assert(frequencies.size() == 5 && frequencies[3] == "xxxx");
+    frequencies.clear();
+    assert(frequencies.empty());
+}
+
+/**
+ * @brief Politica multiset per gli alberi di test
+ * 
+ */
+struct multiset_policy : tree_policy{
+    typedef multi_keys duplicates;
+};
+/**
+ * @brief Test sulla rimozione e sulla modalità multiset
+ * 
+ */
+void test_multiset(){
+    std::cout<<"***** TEST BINARY SEARCH TREE MULTISET *****"<<std::endl;
+    typedef binary_search_tree<int, equals_int, compare_int, multiset_policy> multi_tree;
+    multi_tree tree;
+    for(int i = 0; i < 30; ++i)
+        tree.add(i % 7);
+    assert(tree.size() == 7 && tree.total() == 30);
+    assert(tree.count(0) == 5 && tree.count(6) == 4 && tree.count(7) == 0);
+    assert(tree.remove_one(0) && tree.count(0) == 4);
+    assert(!tree.remove_one(100));
+    while(tree.count(3) > 0)
+        tree.remove_one(3);
+    assert(!tree.contains(3) && tree.size() == 6);
+    assert(tree.remove(6) && !tree.contains(6) && tree.size() == 5);
+    assert(*tree.add(tree.find(5), 5) == 5 && tree.count(5) == 5);
+    assert(tree.total() == 22 && tree.subtree(tree.root()).total() == 22);
+
+    multi_tree copy(tree);
+    assert(copy.count(5) == 5 && copy.count(0) == 4 && copy.total() == 22);
+
+    int values[] = {9, 1, 9, 9, 1, 8};
+    assert(copy.add_batch(values, values + 6) == 6);
+    assert(copy.count(9) == 3 && copy.count(1) == 7 && copy.count(8) == 1 && copy.total() == 28);
+    multi_tree fresh;
+    assert(fresh.add_batch(values, values + 6) == 6);
+    assert(fresh.size() == 3 && fresh.total() == 6 && fresh.count(9) == 3 && fresh.count(1) == 2);
+    fresh.clear();
+    assert(fresh.total() == 0);
+
+    binary_search_tree<int, equals_int, compare_int> t = create_tree_int();
+    assert(t.count(4) == 1 && t.count(40) == 0);
+    assert(t.remove(6));
+    assert(t.size() == 8 && t.total() == 8 && !t.contains(6) && t.root() == 7);
+    assert(t.remove(1) && t.remove(9) && !t.remove(9));
+    int expected[] = {2, 3, 4, 5, 7, 8};
+    int i = 0;
+    for(binary_search_tree<int, equals_int, compare_int>::const_iterator b = t.begin(); b != t.end(); ++b, ++i)
+        assert(*b == expected[i]);
+    assert(i == 6);
+    t.add(1);
+    t.add(10);
+    assert(*t.begin() == 1);
+    for(i = 1; i <= 10; ++i)
+        t.remove(i);
+    assert(t.empty() && t.size() == 0 && t.begin() == t.end());
+    t.add(3);
+    assert(t.root() == 3 && *t.begin() == 3);
+}
+
+/**
+ * @brief Politica splay per gli alberi di test
+ * 
+ */
+struct splay_policy : tree_policy{
+    typedef splay_access access;
+};
+/**
+ * @brief Politica transpose per gli alberi di test
+ * 
+ */
+struct transpose_policy : tree_policy{
+    typedef transpose_access access;
+};
+/**
+ * @brief Test sulle politiche di accesso adattive
+ * 
+ */
+void test_adaptive_access(){
+    std::cout<<"***** TEST BINARY SEARCH TREE ADAPTIVE ACCESS *****"<<std::endl;
+    binary_search_tree<int, equals_int, compare_int, splay_policy> tree;
+    for(int i = 0; i < 1000; ++i)
+        tree.add(i);
+    assert(tree.root() == 0);
+    assert(tree.contains(999));
+    assert(tree.root() == 999);
+    assert(tree.contains(500) && tree.root() == 500);
+    assert(!tree.contains(5000) && tree.root() == 500);
+    assert(*tree.find(3) == 3 && tree.root() == 3);
+    assert(tree.size() == 1000);
+    int expected = 0;
+    binary_search_tree<int, equals_int, compare_int, splay_policy>::const_iterator b;
+    for(b = tree.begin(); b != tree.end(); ++b, ++expected)
+        assert(*b == expected);
+    assert(expected == 1000);
+    assert(tree.remove(3) && !tree.contains(3) && tree.size() == 999);
+
+    const binary_search_tree<int, equals_int, compare_int, splay_policy> &ctree = tree;
+    assert(ctree.contains(42) && ctree.root() == 42);
+
+    binary_search_tree<int, equals_int, compare_int, transpose_policy> t;
+    t.add(5);
+    t.add(3);
+    t.add(1);
+    assert(t.contains(1) && t.root() == 5);
+    assert(t.contains(1) && t.root() == 1);
+    assert(*t.begin() == 1);
+    expected = 1;
+    for(binary_search_tree<int, equals_int, compare_int, transpose_policy>::const_iterator i = t.begin(); i != t.end(); ++i, expected += 2)
+        assert(*i == expected);
+}
+
+/**
+ * @brief Test sulla ricollocazione contigua dei nodi
+ * 
+ */
+void test_compact(){
+    std::cout<<"***** TEST BINARY SEARCH TREE COMPACT *****"<<std::endl;
+    typedef binary_search_tree<int, equals_int, compare_int> int_tree;
+    int_tree tree;
+    for(int i = 0; i < 200; ++i)
+        tree.add((i * 37) % 200);
+    tree.compact();
+    assert(tree.size() == 200 && tree.root() == 0);
+    int expected = 0;
+    for(int_tree::const_iterator b = tree.begin(); b != tree.end(); ++b, ++expected)
+        assert(*b == expected);
+    assert(expected == 200);
+
+    for(int i = 0; i < 200; i += 2)
+        assert(tree.remove(i));
+    for(int i = 200; i < 220; ++i)
+        tree.add(i);
+    assert(tree.size() == 120);
+    tree.compact(int_tree::pre_order_layout);
+    assert(tree.size() == 120 && tree.contains(199) && !tree.contains(100) && tree.contains(219));
+    expected = 1;
+    for(int_tree::const_iterator b = tree.begin(); b != tree.end(); ++b){
+        assert(*b == expected);
+        expected += expected < 199 ? 2 : 1;
+    }
+
+    int_tree copy(tree);
+    tree.compact();
+    tree = copy;
+    assert(tree.size() == 120);
+    tree.clear();
+    tree.compact();
+    assert(tree.empty());
+
+    binary_search_tree<std::string, equals_string, compare_string> tree_s = create_tree_string();
+    tree_s.compact(binary_search_tree<std::string, equals_string, compare_string>::pre_order_layout);
+    assert(tree_s.root() == "c++" && tree_s.size() == 14 && tree_s.contains("spark sql"));
+    std::cout<< tree_s <<std::endl;
+    assert(tree_s.remove("c++") && tree_s.size() == 13);
+    tree_s.add("rust");
+    assert(tree_s.contains("rust") && !tree_s.contains("c++"));
+}
+
+/**
+ * @brief Funtore che raccoglie i valori esportati
+ * 
+ */
+struct collect_sink{
+    std::vector<int> *values;///< vettore in cui raccogliere i valori
+    void operator()(int v){
+        values->push_back(v);
+    }
+};
+/**
+ * @brief Test sull'esportazione in background
+ * 
+ */
+void test_export_async(){
+    std::cout<<"***** TEST BINARY SEARCH TREE EXPORT ASYNC *****"<<std::endl;
+    binary_search_tree<int, equals_int, compare_int> tree = create_tree_int();
+    std::vector<int> exported;
+    collect_sink sink = {&exported};
+    std::future<std::size_t> done = export_async(tree, sink);
+    tree.add(100);
+    tree.remove(1);
+    tree.clear();
+    assert(done.get() == 9);
+    assert(exported.size() == 9);
+    for(int i = 0; i < 9; ++i)
+        assert(exported[i] == i + 1);
+
+    binary_search_tree<std::string, equals_string, compare_string> tree_s = create_tree_string();
+    std::future<std::size_t> file_done = export_async(tree_s, "test_export.txt");
+    tree_s.add("rust");
+    assert(file_done.get() == 14);
+    std::ifstream in("test_export.txt");
+    std::string line;
+    std::getline(in, line);
+    assert(line == "c");
+    unsigned int lines = 1;
+    while(std::getline(in, line))
+        ++lines;
+    assert(lines == 14);
+    in.close();
+    std::remove("test_export.txt");
+
+    try{
+        export_async(tree_s, "/nonexistent/dir/out.txt");
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout<< e.what() <<std::endl;
+    }
+
+    // il file si apre ma ogni scrittura fallisce (ENOSPC): l'errore arriva dal future
+    std::future<std::size_t> full = export_async(tree_s, "/dev/full");
+    try{
+        full.get();
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout<< e.what() <<std::endl;
+    }
+}
+
+/**
+ * @brief Test sul caricamento a pipeline da file
+ * 
+ */
+void test_bulk_loader(){
+    std::cout<<"***** TEST BULK LOADER *****"<<std::endl;
+    {
+        std::ofstream out("test_ints.txt");
+        for(int i = 0; i < 20000; ++i)
+            out<< (i * 7919) % 10000 <<"\n";
+        out<<"not a number\n-5\n12abc\n99999999999\n-2147483649\n2147483647 \n  42";
+    }
+    binary_search_tree<int, equals_int, compare_int> tree;
+    tree.add(-1);
+    bulk_loader<int, int_parser> loader(int_parser(), 3, 4096);
+    load_stats stats = loader.load_file("test_ints.txt", tree);
+    std::cout<<"bytes: "<<stats.bytes<<" records: "<<stats.records<<" inserted: "<<stats.inserted
+             <<" read: "<<stats.read_seconds<<"s parse: "<<stats.parse_seconds<<"s merge: "<<stats.merge_seconds<<"s"<<std::endl;
+    assert(stats.records == 20003);
+    assert(stats.inserted == 10002);
+    assert(tree.size() == 10003);
+    assert(tree.contains(-5) && tree.contains(9999) && tree.contains(42) && tree.contains(2147483647));
+    int parsed = 0;
+    assert(!tree.contains(static_cast<int>(99999999999LL)));
+    assert(!int_parser()("12abc", "12abc" + 5, parsed));
+    assert(!int_parser()("-", "-" + 1, parsed) && int_parser()("-2147483648", "-2147483648" + 11, parsed) && parsed == -2147483647 - 1);
+    std::remove("test_ints.txt");
+
+    {
+        std::ofstream out("test_points.txt");
+        out<<"1 1\n6 6\n2 2\n-3 -3\nbroken\n 7\t8 \n1 2 3\n9\n";
+    }
+    binary_search_tree<point, equals_point, compare_point> tree_point;
+    bulk_loader<point, point_parser<point> > point_loader;
+    load_stats point_stats = point_loader.load_file("test_points.txt", tree_point);
+    assert(point_stats.records == 5 && point_stats.inserted == 5);
+    assert(tree_point.contains(point(-3,-3)) && tree_point.contains(point(7,8)) && tree_point.size() == 5);
+    std::remove("test_points.txt");
+
+    binary_search_tree<std::string, equals_string, compare_string> tree_s;
+    bulk_loader<std::string, string_parser> string_loader;
+    try{
+        string_loader.load_file("/nonexistent/words.txt", tree_s);
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout<< e.what() <<std::endl;
+    }
+}
+
+/**
+ * @brief Test sulle funzioni che segnalano gli errori senza eccezioni
+ * 
+ */
+void test_try_api(){
+    std::cout<<"***** TEST TRY_ROOT / TRY_ADD *****"<<std::endl;
+    typedef binary_search_tree<int, equals_int, compare_int> int_tree;
+    int_tree tree;
+    assert(tree.try_root() == nullptr);
+    assert(tree.try_add(5) == int_tree::add_inserted);
+    assert(tree.try_add(3) == int_tree::add_inserted);
+    assert(tree.try_add(5) == int_tree::add_duplicate);
+    assert(tree.size() == 2 && tree.try_root() != nullptr && *tree.try_root() == 5);
+    tree.clear();
+    assert(tree.try_root() == nullptr);
+
+    typedef binary_search_tree<int, equals_int, compare_int, multiset_policy> multi_tree;
+    multi_tree multi;
+    assert(multi.try_add(1) == multi_tree::add_inserted);
+    assert(multi.try_add(1) == multi_tree::add_copy);
+    assert(multi.size() == 1 && multi.count(1) == 2);
+
+    typedef binary_search_tree<std::string, equals_string, compare_string> string_tree;
+    string_tree tree_s;
+    tree_s.add("c++");
+    assert(tree_s.try_add("c++") == string_tree::add_duplicate);
+    assert(*tree_s.try_root() == "c++");
+}
+
+
+/**
+ * @brief Valore la cui copia lancia std::bad_alloc quando il budget di copie è esaurito
+ * 
+ */
+struct fragile{
+    static std::atomic<long> budget;///< copie ancora consentite
+    static std::atomic<long> live;///< istanze vive
+    int v;
+
+    fragile(int x = 0): v(x){
+        ++live;
+    }
+    fragile(const fragile &other): v(other.v){
+        if(--budget < 0)
+            throw std::bad_alloc();
+        ++live;
+    }
+    fragile& operator=(const fragile &other) = default;
+    ~fragile(){
+        --live;
+    }
+};
+std::atomic<long> fragile::budget(0);
+std::atomic<long> fragile::live(0);
+
+struct equals_fragile{
+    bool operator()(const fragile &a, const fragile &b) const{
+        return a.v == b.v;
+    }
+};
+struct compare_fragile{
+    bool operator()(const fragile &a, const fragile &b) const{
+        return a.v < b.v;
+    }
+};
+
+/**
+ * @brief Test su copia e costruzione bilanciata in parallelo e sulla loro sicurezza rispetto alle eccezioni
+ * 
+ */
+void test_parallel_build(){
+    std::cout<<"***** TEST PARALLEL COPY / BUILD *****"<<std::endl;
+    typedef binary_search_tree<int, equals_int, compare_int> int_tree;
+    const int n = 300000;
+    std::vector<int> values(n);
+    for(int i = 0; i < n; ++i)
+        values[i] = static_cast<int>((i * 7919LL) % n);
+    int_tree tree;
+    assert(tree.add_batch(values.begin(), values.end()) == std::size_t(n));
+    assert(tree.size() == n && tree.root() == n / 2);
+
+    int_tree copy(tree);
+    assert(copy.size() == tree.size() && copy.root() == tree.root());
+    int expected = 0;
+    for(int_tree::const_iterator b = copy.begin(); b != copy.end(); ++b, ++expected)
+        assert(*b == expected);
+    assert(expected == n);
+    int_tree sub = tree.subtree(n / 4);
+    assert(sub.root() == n / 4 && sub.contains(0) && !sub.contains(n / 2));
+
+    typedef binary_search_tree<fragile, equals_fragile, compare_fragile> fragile_tree;
+    std::vector<fragile> fvalues(values.begin(), values.end());
+    fragile::budget = 10 * n;
+    fragile_tree ftree;
+    ftree.add_batch(fvalues.begin(), fvalues.end());
+    long before = fragile::live;
+    fragile::budget = n / 2;
+    try{
+        fragile_tree fcopy(ftree);
+        assert(false);
+    }catch(const std::bad_alloc &){
+        assert(fragile::live == before);
+    }
+
+    fragile::budget = n + n / 2;
+    fragile_tree fbuilt;
+    try{
+        fbuilt.add_batch(fvalues.begin(), fvalues.end());
+        assert(false);
+    }catch(const std::bad_alloc &){
+        assert(fragile::live == before && fbuilt.empty() && fbuilt.size() == 0);
+    }
+}
+
+/**
+ * @brief Test sulla copia di un albero degenere in una catena
+ * 
+ */
+void test_degenerate_copy(){
+    std::cout<<"***** TEST DEGENERATE COPY *****"<<std::endl;
+    const int n = 100000;
+    binary_search_tree<int, equals_int, compare_int> chain;
+    binary_search_tree<int, equals_int, compare_int>::const_iterator hint = chain.end();
+    for(int i = 0; i < n; ++i)
+        hint = chain.add(hint, i);
+    assert(chain.root() == 0);
+
+    binary_search_tree<int, equals_int, compare_int> copy(chain);
+    binary_search_tree<int, equals_int, compare_int> part = chain.subtree(n / 2);
+    assert(copy.size() == static_cast<std::size_t>(n) && part.size() == static_cast<std::size_t>(n / 2));
+    int expected = 0;
+    for(binary_search_tree<int, equals_int, compare_int>::const_iterator b = copy.begin(); b != copy.end(); ++b, ++expected)
+        assert(*b == expected);
+    assert(expected == n && part.min() == n / 2 && part.max() == n - 1);
+}
+
+/**
+ * @brief Politica di debug con accesso splay
+ * 
+ */
+struct checked_splay_policy : debug_policy{
+    typedef splay_access access;
+};
+
+/**
+ * @brief Test sulla verifica degli invarianti e della coerenza dei funtori
+ * 
+ */
+void test_invariants(){
+    std::cout<<"***** TEST DEBUG INVARIANTS *****"<<std::endl;
+    typedef binary_search_tree<int, equals_int, compare_int, debug_policy> checked_tree;
+    checked_tree tree;
+    for(int i = 0; i < 100; ++i)
+        tree.add((i * 37) % 100);
+    std::vector<int> values;
+    for(int i = 50; i < 150; ++i)
+        values.push_back(i);
+    assert(tree.add_batch(values.begin(), values.end()) == 50);
+    assert(tree.remove(10) && tree.remove_one(20) && tree.try_add(10) == checked_tree::add_inserted);
+    tree.compact(checked_tree::pre_order_layout);
+    checked_tree copy(tree);
+    assert(copy.size() == 149 && tree.subtree(tree.root()).size() == 149);
+
+    binary_search_tree<int, equals_int, compare_int, checked_splay_policy> splay;
+    splay.add_batch(values.begin(), values.end());
+    for(int i = 0; i < 200; i += 3)
+        splay.contains(i);
+    assert(splay.size() == 100);
+
+    // compare_point non è un ordinamento debole stretto: (-4,-1) e (-3,-3) non sono confrontabili
+    binary_search_tree<point, equals_point, compare_point, debug_policy> tree_point;
+    tree_point.add(point(1,1));
+    tree_point.add(point(-3,-3));
+    try{
+        tree_point.add(point(-4,-1));
+        assert(false);
+    }catch(const broken_invariant_exception &e){
+        std::cout<< e.what() <<std::endl;
+    }
+}
+
+/**
+ * @brief Test sul calcolo della memoria occupata
+ * 
+ */
+void test_memory_usage(){
+    std::cout<<"***** TEST MEMORY USAGE *****"<<std::endl;
+    typedef binary_search_tree<int, equals_int, compare_int> int_tree;
+    int_tree tree;
+    assert(tree.memory_usage().total() == 0);
+    for(int i = 0; i < 100; ++i)
+        tree.add((i * 37) % 100);
+    memory_stats stats = tree.memory_usage();
+    std::size_t node_size = stats.node_bytes / 100;
+    assert(stats.node_bytes == 100 * node_size && node_size >= sizeof(int) + 3 * sizeof(void*));
+    assert(stats.payload_bytes == 0);
+    std::cout<<"int tree: nodes "<<stats.node_bytes<<" payload "<<stats.payload_bytes<<" slack "<<stats.slack_bytes<<std::endl;
+
+    for(int i = 0; i < 100; i += 2)
+        tree.remove(i);
+    tree.compact();
+    stats = tree.memory_usage();
+    assert(stats.node_bytes == 50 * node_size);
+    tree.remove(1);
+    assert(tree.memory_usage().node_bytes == 49 * node_size);
+    assert(tree.memory_usage().slack_bytes >= stats.slack_bytes + node_size);
+
+    binary_search_tree<std::string, equals_string, compare_string> tree_s;
+    tree_s.add("go");
+    assert(tree_s.memory_usage().payload_bytes == 0);
+    std::string long_string(100, 'x');
+    tree_s.add(long_string);
+    assert(tree_s.memory_usage().payload_bytes >= 101);
+
+    bst_map<std::string, std::string, equals_string, compare_string> m;
+    m["a"] = long_string;
+    m[long_string] = "b";
+    assert(m.memory_usage().payload_bytes >= 202);
+}
+
+/**
+ * @brief Funtore che ritorna le coordinate di un punto per kd_tree
+ * 
+ */
+struct point_axis{
+    int operator()(const point &p, unsigned int axis) const{
+        return axis == 0 ? p.getX() : p.getY();
+    }
+};
+
+/**
+ * @brief Test sull'indice spaziale a due dimensioni
+ * 
+ */
+void test_kd_tree(){
+    std::cout<<"***** TEST KD TREE *****"<<std::endl;
+    typedef kd_tree<point, equals_point, point_axis> point_index;
+    point_index index;
+    assert(index.empty() && index.begin() == index.end());
+    std::vector<point> points;
+    for(int i = 0; i < 2000; ++i)
+        points.push_back(point((i * 37) % 101 - 50, (i * 53) % 97 - 48));
+    // inserimenti ordinati sull'asse x: la ricostruzione mantiene l'albero bilanciato
+    for(int i = 0; i < 500; ++i)
+        points.push_back(point(1000 + i, 0));
+    for(std::size_t i = 0; i < points.size(); ++i){
+        if(!index.contains(points[i]))
+            index.add(points[i]);
+    }
+    try{
+        index.add(point(1000, 0));
+        assert(false);
+    }catch(const existing_node_exception &e){
+        std::cout<< e.what() <<std::endl;
+    }
+    std::size_t visited = 0;
+    for(point_index::const_iterator b = index.begin(); b != index.end(); ++b, ++visited)
+        assert(index.contains(*b));
+    assert(visited == index.size() && index.find(point(1499, 0)) != index.end() && !index.contains(point(2000, 0)));
+
+    // quarto quadrante come is_located_in_quadrant_4, senza visitare tutti i nodi
+    std::vector<point> quadrant;
+    index.range_query(point(-50, -48), point(-1, -1), std::back_inserter(quadrant));
+    std::size_t expected = 0;
+    for(point_index::const_iterator b = index.begin(); b != index.end(); ++b)
+        expected += is_located_in_quadrant_4(*b);
+    assert(quadrant.size() == expected);
+    for(std::size_t i = 0; i < quadrant.size(); ++i)
+        assert(is_located_in_quadrant_4(quadrant[i]));
+
+    point target(7, -3);
+    std::vector<point> near;
+    index.nearest(target, 5, std::back_inserter(near));
+    assert(near.size() == 5);
+    std::vector<double> distances;
+    for(point_index::const_iterator b = index.begin(); b != index.end(); ++b)
+        distances.push_back(b->distance_from(target));
+    std::sort(distances.begin(), distances.end());
+    for(std::size_t i = 0; i < near.size(); ++i)
+        assert(near[i].distance_from(target) == distances[i]);
+
+    point_index copy(index);
+    index.clear();
+    assert(index.empty() && copy.size() == visited && copy.contains(point(1200, 0)));
+    std::vector<point> one;
+    copy.nearest(point(1200, 1), 1, std::back_inserter(one));
+    assert(one.size() == 1 && one[0] == point(1200, 0));
+}
+
+/**
+ * @brief Test sull'indice di stringhe con prefissi condivisi
+ * 
+ */
+void test_radix_tree(){
+    std::cout<<"***** TEST RADIX TREE *****"<<std::endl;
+    binary_search_tree<std::string, equals_string, compare_string> tree_s = create_tree_string();
+    radix_tree index;
+    assert(index.empty() && index.begin() == index.end());
+    for(binary_search_tree<std::string, equals_string, compare_string>::const_iterator b = tree_s.begin(); b != tree_s.end(); ++b)
+        index.add(*b);
+    assert(index.size() == tree_s.size());
+    std::cout<< index <<std::endl;
+
+    // la visita produce le chiavi nello stesso ordine dell'albero binario di ricerca
+    binary_search_tree<std::string, equals_string, compare_string>::const_iterator bst = tree_s.begin();
+    for(radix_tree::const_iterator b = index.begin(); b != index.end(); ++b, ++bst)
+        assert(*b == *bst);
+    assert(bst == tree_s.end());
+
+    // le chiavi che iniziano con 'c' senza visitare le altre
+    bst_iterator_range<radix_tree::const_iterator> c = index.prefix_range("c");
+    assert(bst_count_if(c, string_starts_with_c) == 3 && bst_count_if(index, string_starts_with_c) == 3);
+    radix_tree::const_iterator it = c.begin();
+    assert(*it == "c" && *(++it) == "c#" && *(++it) == "c++" && ++it == c.end());
+    assert(bst_count_if(index.prefix_range("sp"), lenght_equal_4) == 0);
+    assert(bst_count_if(index.prefix_range("s"), string_starts_with_c) == 0);
+    bst_iterator_range<radix_tree::const_iterator> spr = index.prefix_range("spr");
+    assert(*spr.begin() == "spring boot" && ++spr.begin() == spr.end());
+    assert(index.prefix_range("sq").begin() != index.end() && index.prefix_range("x").begin() == index.end());
+    assert(index.prefix_range("spx").begin() == index.end() && index.prefix_range("java script").begin() == index.end());
+    assert(bst_count_if(index.prefix_range(""), lenght_equal_4) == bst_count_if(tree_s, lenght_equal_4));
+
+    try{
+        index.add("c++");
+        assert(false);
+    }catch(const existing_node_exception &e){
+        std::cout<< e.what() <<std::endl;
+    }
+    assert(index.contains("spark sql") && !index.contains("spark") && !index.contains("s"));
+    index.add("spark");
+    index.add("");
+    assert(index.contains("spark") && index.contains("") && *index.begin() == "");
+
+    radix_tree copy(index);
+    assert(index.remove("spark sql") && !index.remove("spark sql") && index.remove(""));
+    assert(index.remove("spring boot") && index.contains("spark") && index.contains("sql"));
+    assert(index.remove("c") && index.remove("c#") && index.remove("c++") && index.prefix_range("c").begin() == index.end());
+    assert(index.size() == tree_s.size() - 4 && copy.size() == tree_s.size() + 2);
+    index = copy;
+    assert(index.size() == copy.size() && index.contains("c#") && index.contains(""));
+    std::size_t n = 0;
+    for(radix_tree::const_iterator b = index.begin(); b != index.end(); ++b, ++n);
+    assert(n == index.size());
+    index.clear();
+    assert(index.empty() && index.begin() == index.end());
+}
+
+void test_filter(){
+    std::cout<<"***** TEST MEMBERSHIP FILTER *****"<<std::endl;
+    binary_search_tree<int, equals_int, compare_int> tree;
+    assert(tree.filter_statistics().lookups == 0);
+    for(int i = 0; i < 100; ++i)
+        tree.add(2 * i);
+    tree.enable_filter(0.01, 64); // capacità più piccola dei valori: il filtro viene ridimensionato
+    for(int i = 100; i < 5000; ++i)
+        tree.add(2 * i);
+
+    // nessun falso negativo, e quasi tutti i valori dispari non scendono nell'albero
+    for(int i = 0; i < 10000; ++i)
+        assert(tree.contains(i) == (i % 2 == 0));
+    filter_stats stats = tree.filter_statistics();
+    assert(stats.lookups == 10000 && stats.filtered + stats.false_positives == 5000);
+    assert(stats.false_positives < 250);
+    std::cout<<"filtered: "<<stats.filtered<<" false positives: "<<stats.false_positives<<std::endl;
+    assert(tree.find(3) == tree.end() && *tree.find(4) == 4 && tree.count(5) == 0 && tree.count(6) == 1);
+
+    // rimozioni, copia e clear tengono il filtro allineato all'albero
+    for(int i = 0; i < 5000; i += 2)
+        tree.remove(2 * i);
+    binary_search_tree<int, equals_int, compare_int> copy(tree);
+    for(int i = 0; i < 10000; i += 2){
+        assert(tree.contains(i) == (i % 4 == 2));
+        assert(copy.contains(i) == (i % 4 == 2));
+    }
+    assert(tree.filter_statistics().filtered > stats.filtered);
+    tree.clear();
+    assert(!tree.contains(2) && tree.filter_statistics().filtered > 0);
+    std::vector<int> batch;
+    for(int i = 0; i < 3000; ++i)
+        batch.push_back(3 * i);
+    tree.add_batch(batch.begin(), batch.end());
+    for(int i = 0; i < 9000; ++i)
+        assert(tree.contains(i) == (i % 3 == 0));
+    tree.add_batch(batch.begin(), batch.end());
+    assert(tree.size() == 3000);
+
+    // add_batch su un albero vuoto inserisce ogni valore nel filtro una volta sola:
+    // dopo le rimozioni tutti i contatori tornano a zero
+    binary_search_tree<int, equals_int, compare_int> batched;
+    batched.enable_filter();
+    batch.clear();
+    for(int i = 0; i < 1000; ++i)
+        batch.push_back(i);
+    batched.add_batch(batch.begin(), batch.end());
+    for(int i = 0; i < 1000; ++i)
+        assert(batched.remove(i));
+    std::size_t filtered = batched.filter_statistics().filtered;
+    for(int i = 0; i < 1000; ++i)
+        assert(!batched.contains(i));
+    assert(batched.filter_statistics().filtered - filtered == 1000);
+
+    // le copie dello stesso valore in un multiset condividono un solo inserimento nel filtro
+    typedef binary_search_tree<int, equals_int, compare_int, multiset_policy> multi_tree;
+    multi_tree multi;
+    multi.enable_filter();
+    multi.add(7);
+    multi.add(7);
+    assert(multi.remove_one(7) && multi.contains(7));
+    assert(multi.remove_one(7) && !multi.contains(7));
+    assert(multi.filter_statistics().filtered == 1);
+
+    tree.disable_filter();
+    assert(tree.contains(0) && tree.filter_statistics().lookups == 0);
+}
+
+/**
+ * @brief Aggregato non commutativo: concatena i valori in ordine, separati da spazi
+ * 
+ */
+struct concat_aggregate{
+    typedef std::string value_type;
+
+    static std::string identity(){
+        return std::string();
+    }
+    static std::string lift(int value, std::size_t copies){
+        std::string s;
+        for(std::size_t i = 0; i < copies; ++i)
+            s += std::to_string(value) + " ";
+        return s;
+    }
+    static std::string combine(const std::string &a, const std::string &b){
+        return a + b;
+    }
+};
+/**
+ * @brief Politiche con aggregati per gli alberi di test
+ * 
+ */
+struct sum_policy : tree_policy{
+    typedef sum_aggregate<long long> aggregate;
+};
+struct splay_min_policy : tree_policy{
+    typedef splay_access access;
+    typedef min_aggregate<int> aggregate;
+};
+struct transpose_max_policy : tree_policy{
+    typedef transpose_access access;
+    typedef max_aggregate<int> aggregate;
+};
+struct multi_concat_policy : multiset_policy{
+    typedef concat_aggregate aggregate;
+};
+
+/**
+ * @brief Confronta aggregate(a, b) con l'accumulo lungo la visita in ordine
+ * 
+ */
+template<typename Tree, typename Agg>
+void check_aggregate(const Tree &tree, int a, int b, Agg){
+    typename Agg::value_type expected = Agg::identity();
+    for(typename Tree::const_iterator i = tree.begin(); i != tree.end(); ++i)
+        if(*i >= a && *i <= b)
+            expected = Agg::combine(expected, Agg::lift(*i, 1));
+    assert(tree.aggregate(a, b) == expected);
+}
+
+/**
+ * @brief Test sugli aggregati dei sotto-alberi mantenuti da inserimenti, rimozioni e rotazioni
+ * 
+ */
+void test_aggregate(){
+    std::cout<<"***** TEST SUBTREE AGGREGATES *****"<<std::endl;
+    binary_search_tree<int, equals_int, compare_int, sum_policy> sums;
+    binary_search_tree<int, equals_int, compare_int, splay_min_policy> mins;
+    binary_search_tree<int, equals_int, compare_int, transpose_max_policy> maxs;
+    assert(sums.aggregate() == 0 && sums.aggregate(0, 100) == 0);
+    assert(mins.aggregate(0, 100) == std::numeric_limits<int>::max());
+    long long total = 0;
+    for(int i = 0; i < 500; ++i){
+        int v = (i * 7919) % 1000;
+        sums.add(v);
+        mins.add(v);
+        maxs.add(v);
+        total += v;
+    }
+    assert(sums.aggregate() == total);
+    for(int i = 0; i < 1000; i += 97){
+        mins.contains(i); // le rotazioni di splay e transpose aggiornano i riepiloghi
+        maxs.contains(i);
+    }
+    for(int i = 0; i < 500; i += 3){
+        int v = (i * 7919) % 1000;
+        sums.remove(v);
+        mins.remove(v);
+        maxs.remove(v);
+    }
+    for(int a = -10; a < 1010; a += 37){
+        for(int b = a - 40; b < 1010; b += 101){
+            check_aggregate(sums, a, b, sum_aggregate<long long>());
+            check_aggregate(mins, a, b, min_aggregate<int>());
+            check_aggregate(maxs, a, b, max_aggregate<int>());
+        }
+    }
+    assert(mins.aggregate() == *mins.begin());
+
+    // copia, compattazione e costruzione bilanciata conservano i riepiloghi
+    binary_search_tree<int, equals_int, compare_int, sum_policy> copy(sums);
+    copy.compact();
+    assert(copy.aggregate(100, 700) == sums.aggregate(100, 700));
+    std::vector<int> values;
+    for(int i = 0; i < 1000; ++i)
+        values.push_back(i);
+    copy.clear();
+    copy.add_batch(values.begin(), values.end());
+    assert(copy.aggregate() == 999LL * 1000 / 2 && copy.aggregate(10, 19) == 145);
+    binary_search_tree<int, equals_int, compare_int, sum_policy> sub = copy.subtree(*copy.begin());
+    check_aggregate(sub, 0, 1000, sum_aggregate<long long>());
+
+    // aggregato non commutativo su un multiset: le copie contano e l'ordine è rispettato
+    typedef binary_search_tree<int, equals_int, compare_int, multi_concat_policy> concat_tree;
+    concat_tree multi;
+    int batch[] = {5, 3, 5, 8, 1, 3, 5};
+    multi.add_batch(batch, batch + 7);
+    assert(multi.aggregate() == "1 3 3 5 5 5 8 ");
+    multi.add(3);
+    multi.try_add(9);
+    multi.add_batch(batch, batch + 2);
+    assert(multi.remove_one(5) && multi.remove(1));
+    assert(multi.aggregate() == "3 3 3 3 5 5 5 8 9 ");
+    assert(multi.aggregate(4, 8) == "5 5 5 8 " && multi.aggregate(6, 7) == "" && multi.aggregate(9, 2) == "");
+}
+
+/**
+ * @brief Test sul contenitore diviso in shard, con scritture da più thread
+ * 
+ */
+void test_sharded_tree(){
+    std::cout<<"***** TEST SHARDED TREE *****"<<std::endl;
+    typedef sharded_tree<int, equals_int, compare_int> int_shards;
+    int_shards shards(4);
+    assert(shards.empty() && shards.shard_count() == 1 && shards.begin() == shards.end());
+
+    // valori crescenti: il primo shard cresce finché la divisione non viene ricalcolata
+    const int per_thread = 5000;
+    std::vector<std::thread> writers;
+    for(int t = 0; t < 4; ++t)
+        writers.push_back(std::thread([&shards, t, per_thread](){
+            for(int i = 0; i < per_thread; ++i)
+                shards.add(4 * i + t);
+        }));
+    for(std::size_t t = 0; t < writers.size(); ++t)
+        writers[t].join();
+    assert(shards.size() == 4 * per_thread && shards.shard_count() == 4);
+    std::size_t sum = 0;
+    for(std::size_t i = 0; i < shards.shard_count(); ++i)
+        sum += shards.shard_size(i);
+    assert(sum == shards.size());
+
+    // la visita unisce gli shard in ordine
+    int expected = 0;
+    for(int_shards::const_iterator b = shards.begin(); b != shards.end(); ++b, ++expected)
+        assert(*b == expected);
+    assert(expected == 4 * per_thread);
+
+    try{
+        shards.add(7);
+        assert(false);
+    }catch(const existing_node_exception &e){
+        std::cout<< e.what() <<std::endl;
+    }
+    assert(shards.try_add(7) == int_shards::tree_type::add_duplicate);
+    assert(shards.contains(0) && shards.contains(4 * per_thread - 1) && !shards.contains(-1));
+    assert(shards.remove(0) && !shards.remove(0) && !shards.contains(0) && shards.count(1) == 1);
+    assert(shards.size() == 4 * per_thread - 1);
+
+    int_shards copy(shards);
+    shards.repartition();
+    assert(shards.shard_count() == 4 && *shards.begin() == 1 && shards.size() == copy.size());
+    for(std::size_t i = 0; i < shards.shard_count(); ++i)
+        assert(shards.shard_size(i) >= shards.size() / 4 - 1 && shards.shard_size(i) <= shards.size() / 4 + 1);
+    shards.clear();
+    assert(shards.empty() && shards.begin() == shards.end() && !shards.contains(1));
+    shards = copy;
+    assert(shards.size() == copy.size() && shards.contains(1) && !shards.contains(0));
+
+    // clear e repartition ripetuti con un lettore attivo: le divisioni sostituite
+    // vengono liberate quando il lettore non le usa più
+    shards.clear();
+    std::atomic<bool> stop(false);
+    std::thread reader([&shards, &stop](){
+        while(!stop.load())
+            assert(!shards.contains(-1) && shards.shard_count() >= 1);
+    });
+    for(int round = 0; round < 20; ++round){
+        for(int i = 0; i < 5000; ++i)
+            shards.try_add(i);
+        assert(shards.size() == 5000);
+        shards.clear();
+    }
+    stop = true;
+    reader.join();
+    assert(shards.empty() && shards.shard_count() == 1);
+
+    // in modalità multi_keys le copie sopravvivono alla ridistribuzione
+    sharded_tree<int, equals_int, compare_int, multiset_policy> multi(3);
+    for(int i = 0; i < 30; ++i)
+        multi.add(i % 2);
+    multi.repartition();
+    assert(multi.count(0) == 15 && multi.count(1) == 15 && multi.size() == 2 && multi.shard_count() == 2);
+}
+
+/**
+ * @brief Test sul journal e sui checkpoint dell'albero persistente
+ * 
+ */
+void test_durable_tree(){
+    std::cout<<"***** TEST DURABLE TREE *****"<<std::endl;
+    typedef durable_tree<int, equals_int, compare_int> durable_ints;
+    {
+        durable_ints tree("test_durable", 16, 4096);
+        assert(tree.size() == 0 && tree.recovery().snapshot_values == 0 && tree.recovery().journal_records == 0);
+        for(int i = 0; i < 1000; ++i)
+            tree.add(i);
+        try{
+            tree.add(5);
+            assert(false);
+        }catch(const existing_node_exception &e){
+            std::cout<< e.what() <<std::endl;
+        }
+        assert(tree.try_add(5) == durable_ints::tree_type::add_duplicate);
+        for(int i = 0; i < 1000; i += 3)
+            assert(tree.remove(i));
+        assert(!tree.remove(0));
+    }
+    {
+        // snapshot caricato con add_batch e coda del journal riapplicata
+        durable_ints tree("test_durable", 16, 4096);
+        assert(tree.recovery().snapshot_values > 0 && tree.recovery().journal_records > 0);
+        assert(tree.size() == 666 && tree.recovery().discarded_bytes == 0);
+        for(int i = 0; i < 1000; ++i)
+            assert(tree.contains(i) == (i % 3 != 0));
+        tree.checkpoint();
+        tree.add(3000);
+        tree.sync();
+    }
+    {
+        // un record scritto a metà in coda al journal viene scartato
+        std::ofstream journal("test_durable/journal", std::ios::binary | std::ios::app);
+        journal.write("\x09\x00\x00", 3);
+    }
+    {
+        durable_ints tree("test_durable");
+        assert(tree.recovery().snapshot_values == 666 && tree.recovery().journal_records == 1);
+        assert(tree.recovery().discarded_bytes == 3 && tree.size() == 667 && tree.contains(3000));
+        tree.remove(3000);
+    }
+    {
+        durable_ints tree("test_durable");
+        assert(tree.size() == 666 && !tree.contains(3000));
+        assert(*tree.tree().begin() == 1 && tree.recovery().discarded_bytes == 0);
+    }
+
+    // stringhe con journal_codec e multiset con remove_one
+    typedef durable_tree<std::string, equals_string, compare_string, multiset_policy> durable_strings;
+    {
+        durable_strings words("test_durable_strings", 1);
+        words.add("c++");
+        words.add("c++");
+        words.add("");
+        words.add("rust");
+        words.checkpoint();
+        words.add("rust");
+        assert(words.remove_one("c++") && words.remove("") && !words.remove_one("go"));
+    }
+    {
+        durable_strings words("test_durable_strings", 1);
+        assert(words.tree().count("c++") == 1 && words.tree().count("rust") == 2 && !words.contains(""));
+        assert(words.recovery().snapshot_values == 4 && words.recovery().journal_records == 3);
+    }
+    {
+        // scrittura parziale: il limite sulla dimensione dei file tronca la write a metà
+        // di un record, il secondo sync() non deve duplicare i byte già scritti
+        durable_strings words("test_durable_partial", 1000);
+        for(int i = 0; i < 20; ++i)
+            words.add("partial");
+        struct stat info;
+        assert(::stat("test_durable_partial/journal", &info) == 0);
+        struct rlimit saved, limit;
+        assert(::getrlimit(RLIMIT_FSIZE, &saved) == 0);
+        limit = saved;
+        limit.rlim_cur = info.st_size + 30; // vale per tutti i file, anche per lo stdout rediretto
+        std::cout.flush();
+        std::signal(SIGXFSZ, SIG_IGN);
+        assert(::setrlimit(RLIMIT_FSIZE, &limit) == 0);
+        std::string error;
+        try{
+            words.sync();
+        }catch(const std::runtime_error &e){
+            error = e.what();
+        }
+        assert(::setrlimit(RLIMIT_FSIZE, &saved) == 0);
+        std::signal(SIGXFSZ, SIG_DFL);
+        std::cout<< error <<std::endl;
+        assert(!error.empty());
+        words.sync();
+    }
+    {
+        durable_strings words("test_durable_partial");
+        assert(words.tree().count("partial") == 20 && words.recovery().journal_records == 20);
+        assert(words.recovery().discarded_bytes == 0);
+    }
+
+    const char* files[] = {"test_durable/journal", "test_durable/snapshot",
+                           "test_durable_strings/journal", "test_durable_strings/snapshot",
+                           "test_durable_partial/journal", "test_durable_partial/snapshot"};
+    for(int i = 0; i < 6; ++i)
+        std::remove(files[i]);
+    std::remove("test_durable");
+    std::remove("test_durable_strings");
+    std::remove("test_durable_partial");
+}
+
+/**
+ * @brief Test su min, max, pop_min e pop_max (albero usato come coda con priorità)
+ * 
+ */
+void test_min_max(){
+    std::cout<<"***** TEST MIN / MAX / POP *****"<<std::endl;
+    binary_search_tree<int, equals_int, compare_int, debug_policy> queue;
+    try{
+        queue.min();
+        assert(false);
+    }catch(const empty_tree_exception &e){
+        std::cout<< e.what() <<std::endl;
+    }
+    try{
+        queue.pop_max();
+        assert(false);
+    }catch(const empty_tree_exception &e){
+        std::cout<< e.what() <<std::endl;
+    }
+    for(int i = 0; i < 200; ++i)
+        queue.add((i * 37) % 200);
+    assert(queue.min() == 0 && queue.max() == 199 && *queue.begin() == 0);
+
+    // le scadenze vengono estratte in ordine mentre ne arrivano di nuove
+    int last = -1;
+    for(int i = 0; i < 100; ++i){
+        int next = queue.pop_min();
+        assert(next > last && queue.min() > next);
+        last = next;
+        queue.add(1000 + i);
+    }
+    assert(queue.size() == 200 && queue.max() == 1099 && queue.pop_max() == 1099 && queue.max() == 1098);
+    while(queue.size() > 1)
+        queue.pop_max();
+    assert(queue.min() == 100 && queue.max() == 100 && queue.pop_min() == 100);
+    assert(queue.empty() && queue.begin() == queue.end() && queue.try_root() == nullptr);
+
+    // in modalità multi_keys viene estratta una copia alla volta
+    binary_search_tree<int, equals_int, compare_int, multiset_policy> multi;
+    multi.add(4);
+    multi.add(4);
+    multi.add(9);
+    assert(multi.pop_min() == 4 && multi.count(4) == 1 && multi.pop_min() == 4 && multi.min() == 9);
+
+    // i riepiloghi dei sotto-alberi restano aggiornati
+    binary_search_tree<int, equals_int, compare_int, sum_policy> sums;
+    for(int i = 1; i <= 10; ++i)
+        sums.add(i);
+    assert(sums.pop_min() == 1 && sums.pop_max() == 10 && sums.aggregate() == 44 && sums.aggregate(0, 5) == 14);
+}
+
+/**
+ * @brief Funtori constexpr per gli alberi costruiti in compilazione
+ * 
+ */
+struct equals_code{
+    constexpr bool operator()(int a, int b) const{
+        return a == b;
+    }
+};
+struct compare_code{
+    constexpr bool operator()(int a, int b) const{
+        return a < b;
+    }
+};
+struct equals_name{
+    constexpr bool operator()(const char *a, const char *b) const{
+        return *a == *b && (*a == '\0' || (*this)(a + 1, b + 1));
+    }
+};
+struct compare_name{
+    constexpr bool operator()(const char *a, const char *b) const{
+        return *a != *b ? static_cast<unsigned char>(*a) < static_cast<unsigned char>(*b) : *a != '\0' && (*this)(a + 1, b + 1);
+    }
+};
+
+constexpr int http_codes[] = {404, 200, 500, 301, 418, 204, 503, 302, 100, 403};
+constexpr static_tree<int, 10, equals_code, compare_code> http_tree(http_codes);
+static_assert(http_tree.contains(418) && http_tree.contains(100) && !http_tree.contains(401), "static_tree lookup at compile time");
+static_assert(http_tree.min() == 100 && http_tree.size() == 10, "static_tree built at compile time");
+
+constexpr const char* config_names[] = {"timeout", "retries", "host", "port", "verbose"};
+constexpr static_tree<const char*, 5, equals_name, compare_name> config_tree = make_static_tree<equals_name, compare_name>(config_names);
+static_assert(config_tree.contains("port") && !config_tree.contains("user"), "static_tree with constexpr functors");
+
+/**
+ * @brief Test sull'albero statico costruito in compilazione
+ * 
+ */
+void test_static_tree(){
+    std::cout<<"***** TEST STATIC TREE *****"<<std::endl;
+    std::cout<< http_tree <<std::endl;
+    int expected[] = {100, 200, 204, 301, 302, 403, 404, 418, 500, 503};
+    int i = 0;
+    for(static_tree<int, 10, equals_code, compare_code>::const_iterator b = http_tree.begin(); b != http_tree.end(); ++b, ++i)
+        assert(*b == expected[i]);
+    assert(i == 10 && *http_tree.find(301) == 301 && http_tree.find(302) != http_tree.end() && http_tree.find(303) == http_tree.end());
+    for(int code = 0; code < 600; ++code)
+        assert(http_tree.contains(code) == (std::find(expected, expected + 10, code) != expected + 10));
+
+    // stessa interfaccia dell'albero dinamico, costruita a runtime con funtori non constexpr
+    int keys[] = {7, 3, 9, 1};
+    const static_tree<int, 4, equals_int, compare_int> small(keys);
+    binary_search_tree<int, equals_int, compare_int> dynamic;
+    for(int k = 0; k < 4; ++k)
+        dynamic.add(keys[k]);
+    binary_search_tree<int, equals_int, compare_int>::const_iterator d = dynamic.begin();
+    for(static_tree<int, 4, equals_int, compare_int>::const_iterator b = small.begin(); b != small.end(); ++b, ++d)
+        assert(*b == *d);
+    assert(d == dynamic.end() && small.contains(9) && !small.contains(8));
+
+    std::string names;
+    for(static_tree<const char*, 5, equals_name, compare_name>::const_iterator b = config_tree.begin(); b != config_tree.end(); ++b)
+        names += std::string(*b) + " ";
+    assert(names == "host port retries timeout verbose ");
+
+    int duplicates[] = {5, 1, 5};
+    try{
+        static_tree<int, 3, equals_int, compare_int> broken(duplicates);
+        assert(false);
+    }catch(const existing_node_exception &e){
+        std::cout<< e.what() <<std::endl;
+    }
+    int single[] = {42};
+    static_tree<int, 1, equals_int, compare_int> one(single);
+    assert(*one.begin() == 42 && ++one.begin() == one.end() && one.contains(42));
+}
+
+
+/**
+ * @brief Politiche di eviction per gli alberi di test (con verifica degli invarianti)
+ * 
+ */
+struct fifo_policy : debug_policy{
+    typedef fifo_eviction eviction;
+};
+struct lru_policy : debug_policy{
+    typedef lru_eviction eviction;
+};
+struct lru_multi_policy : debug_policy{
+    typedef multi_keys duplicates;
+    typedef lru_eviction eviction;
+    typedef sum_aggregate<long long> aggregate;
+};
+
+/**
+ * @brief Test su capacità, scadenza dei valori ed eviction
+ * 
+ */
+void test_eviction(){
+    std::cout<<"***** TEST EVICTION *****"<<std::endl;
+    typedef binary_search_tree<int, equals_int, compare_int, fifo_policy> fifo_tree;
+    typedef binary_search_tree<int, equals_int, compare_int, lru_policy> lru_tree;
+    typedef binary_search_tree<int, equals_int, compare_int, lru_multi_policy> multi_tree;
+
+    // fifo: oltre la capacità esce il primo inserito, le ricerche non contano
+    fifo_tree fifo;
+    fifo.set_capacity(3);
+    fifo.add(5);
+    fifo.add(1);
+    fifo.add(9);
+    assert(fifo.contains(5));
+    fifo.add(7);
+    assert(fifo.size() == 3 && !fifo.contains(5) && fifo.contains(1) && fifo.contains(9) && fifo.contains(7));
+    std::cout<< fifo <<std::endl;
+
+    // lru: la ricerca rinnova il valore, esce il meno usato
+    lru_tree lru;
+    lru.set_capacity(3);
+    lru.add(5);
+    lru.add(1);
+    lru.add(9);
+    assert(lru.contains(5));
+    assert(lru.try_add(7) == lru_tree::add_inserted);
+    assert(lru.size() == 3 && lru.contains(5) && !lru.contains(1));
+    assert(lru.find(9) != lru.end());
+    lru.add(lru.find(7), 8);
+    assert(!lru.contains(5) && lru.contains(7) && lru.contains(8) && lru.contains(9));
+    int wanted[] = {7, 5, 9};
+    std::vector<bool> found(3);
+    lru.contains_batch(wanted, wanted + 3, found.begin());
+    assert(found[0] && !found[1] && found[2]);
+
+    // ridurre la capacità rimuove subito i più vecchi; copia, compattazione e
+    // assegnamento mantengono l'ordine della lista
+    lru_tree large;
+    large.set_capacity(100);
+    for(int i = 0; i < 200; ++i)
+        large.add((i * 37) % 200);
+    assert(large.size() == 100 && large.capacity() == 100);
+    for(int i = 100; i < 200; ++i)
+        assert(large.contains((i * 37) % 200));
+    large.compact();
+    lru_tree copy(large);
+    copy.set_capacity(10);
+    assert(copy.size() == 10 && large.size() == 100);
+    for(int i = 190; i < 200; ++i)
+        assert(copy.contains((i * 37) % 200));
+    large = copy;
+    large.add(1000);
+    assert(large.size() == 10 && !large.contains((190 * 37) % 200));
+    lru_tree part = large.subtree(large.root());
+    assert(part.capacity() == 10);
+    part.add(-1);
+
+    // scadenza: un valore scaduto risulta assente e viene rimosso dagli inserimenti
+    fifo_tree cache;
+    cache.set_ttl(std::chrono::hours(1));
+    for(int i = 0; i < 10; ++i)
+        cache.add(i * 3);
+    assert(cache.expire_at(0, std::chrono::steady_clock::now()) && !cache.expire_at(1, std::chrono::steady_clock::now()));
+    assert(!cache.contains(0) && cache.count(0) == 0 && cache.find(0) == cache.end() && cache.size() == 10);
+    cache.add(100);
+    assert(cache.size() == 10);
+    cache.add(0);
+    assert(cache.contains(0) && cache.size() == 11);
+    assert(cache.expire_at(6, std::chrono::steady_clock::now()));
+    assert(cache.try_add(6) == fifo_tree::add_inserted && cache.contains(6));
+    for(int i = 1; i < 5; ++i)
+        cache.expire_at(i * 3, std::chrono::steady_clock::now() - std::chrono::seconds(1));
+    assert(cache.expire() == 4 && cache.size() == 7);
+    int batch[] = {3, 9, 42};
+    assert(cache.add_batch(batch, batch + 3) == 3 && cache.size() == 10);
+
+    cache.set_ttl(std::chrono::milliseconds(1));
+    cache.add(200);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    assert(!cache.contains(200) && cache.expire() == 1 && !cache.expire());
+
+    // un albero vuoto costruito da add_batch entra nella lista nell'ordine dei valori
+    fifo_tree built;
+    built.set_capacity(4);
+    int values[] = {8, 2, 6, 4, 10, 12};
+    built.add_batch(values, values + 6);
+    assert(built.size() == 4 && !built.contains(2) && !built.contains(4) && built.contains(12));
+
+    // multi_keys: un valore scaduto ritorna con una sola copia e gli aggregati restano corretti
+    multi_tree multi;
+    multi.add(4);
+    multi.add(4);
+    multi.add(2);
+    assert(multi.count(4) == 2 && multi.aggregate() == 10);
+    multi.expire_at(4, std::chrono::steady_clock::now());
+    assert(multi.count(4) == 0);
+    multi.add(4);
+    assert(multi.count(4) == 1 && multi.aggregate() == 6);
+    multi.set_capacity(1);
+    assert(multi.size() == 1 && multi.contains(4) && multi.aggregate() == 4);
+    multi.clear();
+    multi.add(3);
+    assert(multi.pop_min() == 3 && multi.size() == 0);
+
+    // la capacità conta ogni copia
+    multi.set_capacity(3);
+    for(int i = 0; i < 5; ++i)
+        multi.add(1);
+    assert(multi.count(1) == 3 && multi.total() == 3 && multi.size() == 1);
+    multi.add(2);
+    assert(multi.count(1) == 2 && multi.count(2) == 1 && multi.total() == 3);
+
+    // i valori scaduti sono assenti anche per min, max, pop, remove, find con hint e cursori
+    fifo_tree timed;
+    for(int i = 0; i < 6; ++i)
+        timed.add(i);
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    timed.expire_at(0, now);
+    timed.expire_at(5, now);
+    timed.expire_at(2, now);
+    assert(timed.min() == 1 && timed.max() == 4);
+    assert(timed.find(timed.begin(), 2) == timed.end() && *timed.find(timed.begin(), 3) == 3);
+    fifo_tree::cursor walk = timed.open_cursor();
+    std::vector<int> live;
+    walk.read(10, std::back_inserter(live));
+    assert(live.size() == 3 && live[0] == 1 && live[1] == 3 && live[2] == 4);
+    // anche iteratori e viste saltano i valori scaduti, size() li conta finché non vengono rimossi
+    assert(*timed.begin() == 1 && *timed.lower_bound(2) == 3 && timed.lower_bound(5) == timed.end());
+    std::vector<int> visited(timed.begin(), timed.end());
+    assert(visited == live && bst_count_if(timed, is_even) == 1 && timed.size() == 6);
+    assert(!timed.remove(2) && timed.size() == 5 && !timed.remove_one(2));
+    assert(timed.pop_min() == 1 && timed.pop_max() == 4 && timed.size() == 1 && timed.min() == 3);
+
+    // la copia ricostruisce la lista d'uso anche per un albero degenere
+    lru_tree chain;
+    lru_tree::const_iterator hint = chain.end();
+    for(int i = 0; i < 2000; ++i)
+        hint = chain.add(hint, i);
+    assert(chain.contains(0));
+    lru_tree chain_copy(chain);
+    chain_copy.set_capacity(1999);
+    assert(!chain_copy.contains(1) && chain_copy.contains(0));
+
+    // una scadenza a metà della lista d'uso viene raggiunta dalla pulizia incrementale
+    fifo_tree swept;
+    for(int i = 0; i < 100; ++i)
+        swept.add(i);
+    swept.expire_at(50, std::chrono::steady_clock::now());
+    for(int i = 100; i < 130; ++i)
+        swept.add(i);
+    assert(swept.size() == 129 && !swept.contains(50));
+}
+
+
+/**
+ * @brief Test sui cursori che restano validi durante le modifiche
+ * 
+ */
+void test_cursor(){
+    std::cout<<"***** TEST CURSOR *****"<<std::endl;
+    typedef binary_search_tree<int, equals_int, compare_int, debug_policy> checked_tree;
+    checked_tree tree;
+    for(int i = 0; i < 100; ++i)
+        tree.add((i * 37) % 100);
+
+    checked_tree::cursor c = tree.open_cursor();
+    std::vector<int> page;
+    assert(c.read(10, std::back_inserter(page)) == 10 && page.front() == 0 && page.back() == 9 && *c == 10);
+
+    // rimozione del valore corrente e di valori più avanti, inserimenti prima e dopo
+    tree.remove(10);
+    assert(*c == 11);
+    tree.add(10);
+    tree.remove(12);
+    tree.remove(13);
+    tree.add(100);
+    checked_tree::cursor other(c);
+    ++other;
+    assert(*c == 11 && *other == 14 && other.position() == tree.find(14));
+
+    // compact sposta i nodi, i cursori li seguono
+    tree.compact();
+    assert(*c == 11 && *other == 14);
+    tree.remove(11);
+    tree.remove(14);
+    assert(*c == 15 && *other == 15);
+    page.clear();
+    c.read(200, std::back_inserter(page));
+    assert(c.at_end() && page.size() == 86 && page.front() == 15 && page.back() == 100);
+
+    // scansione a pagine su un albero modificato tra una pagina e l'altra
+    checked_tree::cursor scan = tree.open_cursor(tree.lower_bound(50));
+    std::vector<int> seen;
+    for(int round = 0; !scan.at_end(); ++round){
+        scan.read(7, std::back_inserter(seen));
+        if(!scan.at_end()){
+            tree.remove(*scan);
+            tree.add(1000 + round);
+        }
+        assert(tree.pop_min() < 50);
+    }
+    for(std::size_t i = 1; i < seen.size(); ++i)
+        assert(seen[i - 1] < seen[i]);
+    assert(seen.front() == 50 && seen.back() > 1000);
+    assert(tree.open_cursor(tree.end()).at_end());
+
+    // le ricerche con splay ruotano l'albero senza cambiare l'ordine
+    binary_search_tree<int, equals_int, compare_int, splay_policy> splayed;
+    for(int i = 0; i < 64; ++i)
+        splayed.add((i * 13) % 64);
+    binary_search_tree<int, equals_int, compare_int, splay_policy>::cursor s = splayed.open_cursor();
+    for(int expected = 0; expected < 64; ++expected, ++s){
+        assert(*s == expected);
+        assert(splayed.contains(63 - expected));
+    }
+    assert(s.at_end());
+
+    // eviction, clear, assegnamento e distruzione dell'albero portano i cursori alla fine
+    binary_search_tree<int, equals_int, compare_int, fifo_policy> cache;
+    for(int i = 0; i < 8; ++i)
+        cache.add(i * 5 % 8);
+    binary_search_tree<int, equals_int, compare_int, fifo_policy>::cursor oldest = cache.open_cursor(cache.find(0));
+    cache.set_capacity(7);
+    assert(*oldest == 1);
+    cache.clear();
+    assert(oldest.at_end());
+
+    checked_tree source;
+    source.add(1);
+    checked_tree::cursor reassigned = tree.open_cursor();
+    tree = source;
+    assert(reassigned.at_end() && !tree.open_cursor().at_end());
+    checked_tree::cursor orphan;
+    {
+        checked_tree scoped(source);
+        orphan = scoped.open_cursor();
+        assert(*orphan == 1);
+    }
+    assert(orphan.at_end());
+}
 
 
 int main(){
@@ -582,6 +2278,32 @@ int main(){
     test_const_bst_point(tree_point);
     test_printIF();
     test_const_iterator();
+    test_batch_lookup();
+    test_add_batch();
+    test_small_keys();
+    test_hinted_add();
+    test_views();
+    test_bst_map();
+    test_multiset();
+    test_adaptive_access();
+    test_compact();
+    test_export_async();
+    test_bulk_loader();
+    test_try_api();
+    test_parallel_build();
+    test_degenerate_copy();
+    test_invariants();
+    test_memory_usage();
+    test_kd_tree();
+    test_radix_tree();
+    test_filter();
+    test_aggregate();
+    test_sharded_tree();
+    test_durable_tree();
+    test_min_max();
+    test_static_tree();
+    test_eviction();
+    test_cursor();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,491 @@
+#ifndef RADIX_TREE_H
+#define RADIX_TREE_H
+#include <algorithm>
+#include <ostream>
+#include <iterator> // std::forward_iterator_tag
+#include <cstddef>  // std::ptrdiff_t, std::size_t
+#include <string>
+#include <vector>
+#include "existing_node_exception.h"
+#include "bst_exceptions.h"
+#include "tree_views.h" // bst_iterator_range
+
+/**
+ * @brief Classe radix_tree
+ *
+ * Insieme ordinato di stringhe memorizzato come albero radix (Patricia): ogni arco
+ * porta una sequenza di caratteri e i prefissi comuni a più chiavi sono
+ * memorizzati una sola volta. I figli di ogni nodo sono ordinati sul primo
+ * carattere dell'arco, quindi la visita in profondità produce le chiavi
+ * nell'ordine di std::string. prefix_range(p) costa O(|p| + k) per le k chiavi
+ * che iniziano con p, perché ogni nodo interno senza chiave ha almeno due figli
+ */
+class radix_tree{
+    /**
+     * @brief Struttura nodo
+     */
+    struct node{
+        std::string label;///< caratteri dell'arco che arriva al nodo
+        bool terminal;///< true se il cammino dalla radice al nodo è una chiave
+        node* parent;///< puntatore al nodo padre
+        std::vector<node*> children;///< figli ordinati sul primo carattere dell'arco
+
+        /**
+         * @brief Costruttore
+         *
+         * @param l caratteri dell'arco
+         * @param p puntatore al nodo padre
+         */
+        node(const std::string &l, node *p): label(l), terminal(false), parent(p){}
+    };
+
+    /**
+     * @brief Funtore che ordina i figli sul primo carattere dell'arco, confrontato
+     * come unsigned char come fa std::string
+     */
+    struct first_char_less{
+        bool operator()(const node *n, unsigned char c) const{
+            return static_cast<unsigned char>(n->label[0]) < c;
+        }
+    };
+
+    node _root;///< radice: arco vuoto, sempre presente
+    std::size_t _size;///< numero di chiavi memorizzate
+
+    /**
+     * @brief Funzione che ritorna la posizione del figlio il cui arco inizia con c
+     * (o la posizione in cui inserirlo)
+     *
+     * @param n nodo padre
+     * @param c primo carattere dell'arco
+     * @return std::vector<node*>::const_iterator posizione nel vettore dei figli
+     */
+    static std::vector<node*>::const_iterator child_position(const node *n, char c){
+        return std::lower_bound(n->children.begin(), n->children.end(), static_cast<unsigned char>(c), first_char_less());
+    }
+
+    /**
+     * @brief Funzione che ritorna il figlio il cui arco inizia con c
+     *
+     * @param n nodo padre
+     * @param c primo carattere dell'arco
+     * @return node* figlio (nullptr se assente)
+     */
+    static node* child(const node *n, char c){
+        std::vector<node*>::const_iterator i = child_position(n, c);
+        if(i == n->children.end() || (*i)->label[0] != c)
+            return nullptr;
+        return *i;
+    }
+
+    /**
+     * @brief Funzione che ritorna la lunghezza del prefisso comune tra label
+     * e la parte di key che inizia in from
+     */
+    static std::size_t common_prefix(const std::string &label, const std::string &key, std::size_t from){
+        std::size_t i = 0;
+        while(i < label.size() && from + i < key.size() && label[i] == key[from + i])
+            ++i;
+        return i;
+    }
+
+    /**
+     * @brief Funzione che cerca il nodo che termina esattamente una chiave
+     *
+     * @param key chiave da cercare
+     * @return node* nodo raggiunto da key (nullptr se key termina a metà di un arco o non c'è)
+     */
+    node* find_node(const std::string &key) const{
+        node* n = const_cast<node*>(&_root);
+        std::size_t i = 0;
+        while(i < key.size()){
+            n = child(n, key[i]);
+            if(n == nullptr || common_prefix(n->label, key, i) != n->label.size())
+                return nullptr;
+            i += n->label.size();
+        }
+        return n;
+    }
+
+    /**
+     * @brief Funzione che copia i figli di un nodo
+     *
+     * @param from nodo da cui copiare
+     * @param to nodo che riceve le copie
+     *
+     * @throw std::bad_alloc eccezione durante l'allocazione di un nodo (il chiamante rimuove le copie già collegate)
+     */
+    static void copy_children(const node *from, node *to){
+        to->children.reserve(from->children.size());
+        for(std::size_t i = 0; i < from->children.size(); ++i){
+            const node* c = from->children[i];
+            node* clone = new node(c->label, to);
+            clone->terminal = c->terminal;
+            to->children.push_back(clone);
+            copy_children(c, clone);
+        }
+    }
+
+    /**
+     * @brief Funzione che dealloca i figli di un nodo e i loro sotto-alberi
+     *
+     * @param n nodo
+     */
+    static void erase_children(node *n){
+        for(std::size_t i = 0; i < n->children.size(); ++i){
+            erase_children(n->children[i]);
+            delete n->children[i];
+        }
+        n->children.clear();
+    }
+
+    /**
+     * @brief Funzione che fonde un nodo senza chiave con il suo unico figlio
+     *
+     * @param n nodo da fondere (non la radice)
+     */
+    static void merge_with_child(node *n){
+        node* c = n->children[0];
+        n->label += c->label;
+        n->terminal = c->terminal;
+        n->children.swap(c->children);
+        for(std::size_t i = 0; i < n->children.size(); ++i)
+            n->children[i]->parent = n;
+        delete c;
+    }
+
+
+    public:
+        class const_iterator;
+
+        /**
+         * @brief Costruttore di default
+         *
+         * @post _size == 0
+         */
+        radix_tree(): _root("", nullptr), _size(0){}
+
+        /**
+         * @brief Copy constructor
+         *
+         * @param other albero da copiare
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        radix_tree(const radix_tree &other): _root("", nullptr), _size(other._size){
+            _root.terminal = other._root.terminal;
+            BST_TRY{
+                copy_children(&other._root, &_root);
+            }BST_CATCH_ALL{
+                erase_children(&_root);
+                BST_RETHROW;
+            }
+        }
+
+        /**
+         * @brief Operatore assegnamento
+         *
+         * @param other albero da copiare
+         * @return radix_tree& riferimento all'albero this
+         */
+        radix_tree& operator=(const radix_tree &other){
+            if(this != &other){
+                radix_tree tmp(other);
+                std::swap(_root.terminal, tmp._root.terminal);
+                _root.children.swap(tmp._root.children);
+                std::swap(_size, tmp._size);
+                for(std::size_t i = 0; i < _root.children.size(); ++i)
+                    _root.children[i]->parent = &_root;
+                for(std::size_t i = 0; i < tmp._root.children.size(); ++i)
+                    tmp._root.children[i]->parent = &tmp._root;
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Distruttore
+         *
+         */
+        ~radix_tree(){
+            erase_children(&_root);
+        }
+
+        /**
+         * @brief Funzione che elimina tutte le chiavi
+         *
+         */
+        void clear(){
+            erase_children(&_root);
+            _root.terminal = false;
+            _size = 0;
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero delle chiavi memorizzate
+         *
+         * @return std::size_t numero delle chiavi
+         */
+        std::size_t size() const{
+            return _size;
+        }
+
+        /**
+         * @brief Funzione che verifica se l'albero è vuoto
+         *
+         * @return true se l'albero è vuoto
+         * @return false se l'albero non è vuoto
+         */
+        bool empty() const{
+            return _size == 0;
+        }
+
+        /**
+         * @brief Funzione che aggiunge una nuova chiave
+         *
+         * Se la chiave si separa da un arco esistente a metà, l'arco viene diviso
+         * in due e la parte comune resta condivisa
+         *
+         * @param key chiave da aggiungere
+         *
+         * @throw existing_node_exception eccezione lanciata se la chiave da aggiungere già esiste
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        void add(const std::string &key){
+            node* n = &_root;
+            std::size_t i = 0;
+            while(i < key.size()){
+                std::vector<node*>::const_iterator pos = child_position(n, key[i]);
+                if(pos == n->children.end() || (*pos)->label[0] != key[i]){
+                    node* leaf = new node(key.substr(i), n);
+                    BST_TRY{
+                        n->children.insert(n->children.begin() + (pos - n->children.begin()), leaf);
+                    }BST_CATCH_ALL{
+                        delete leaf;
+                        BST_RETHROW;
+                    }
+                    leaf->terminal = true;
+                    ++_size;
+                    return;
+                }
+
+                node* c = *pos;
+                std::size_t common = common_prefix(c->label, key, i);
+                if(common < c->label.size()){
+                    // divide l'arco: la parte comune diventa un nuovo nodo padre di c
+                    node* split = new node(c->label.substr(0, common), n);
+                    BST_TRY{
+                        split->children.push_back(c);
+                    }BST_CATCH_ALL{
+                        delete split;
+                        BST_RETHROW;
+                    }
+                    n->children[pos - n->children.begin()] = split;
+                    c->label.erase(0, common);
+                    c->parent = split;
+                }
+                n = n->children[pos - n->children.begin()];
+                i += common;
+            }
+            if(n->terminal)
+                BST_THROW(existing_node_exception("Cannot insert an existing node in the radix tree"));
+            n->terminal = true;
+            ++_size;
+        }
+
+        /**
+         * @brief Funzione che verifica se una chiave è presente
+         *
+         * @param key chiave da cercare
+         * @return true se la chiave è presente
+         * @return false se la chiave non è presente
+         */
+        bool contains(const std::string &key) const{
+            const node* n = find_node(key);
+            return n != nullptr && n->terminal;
+        }
+
+        /**
+         * @brief Funzione che rimuove una chiave
+         *
+         * I nodi rimasti senza chiave e con un solo figlio vengono fusi con il figlio,
+         * così l'albero resta compresso
+         *
+         * @param key chiave da rimuovere
+         * @return true se la chiave era presente ed è stata rimossa
+         * @return false se la chiave non era presente
+         */
+        bool remove(const std::string &key){
+            node* n = find_node(key);
+            if(n == nullptr || !n->terminal)
+                return false;
+            n->terminal = false;
+            --_size;
+
+            if(n != &_root && n->children.empty()){
+                node* p = n->parent;
+                p->children.erase(p->children.begin() + (child_position(p, n->label[0]) - p->children.begin()));
+                delete n;
+                n = p;
+            }
+            if(n != &_root && !n->terminal && n->children.size() == 1)
+                merge_with_child(n);
+            return true;
+        }
+
+        /**
+         * @brief Funzione che ritorna la vista sulle chiavi che iniziano con un prefisso
+         *
+         * @param prefix prefisso
+         * @return bst_iterator_range<const_iterator> chiavi con il prefisso, in ordine
+         */
+        bst_iterator_range<const_iterator> prefix_range(const std::string &prefix) const{
+            const node* n = &_root;
+            std::string path;
+            std::size_t i = 0;
+            while(i < prefix.size()){
+                const node* c = child(n, prefix[i]);
+                if(c == nullptr)
+                    return bst_iterator_range<const_iterator>(end(), end());
+                std::size_t common = common_prefix(c->label, prefix, i);
+                if(i + common < prefix.size() && common < c->label.size())
+                    return bst_iterator_range<const_iterator>(end(), end());
+                n = c;
+                path += c->label;
+                i += common;
+            }
+            return bst_iterator_range<const_iterator>(const_iterator(n, n, path), end());
+        }
+
+        /**
+         * @brief Classe const_iterator
+         *
+         * Visita le chiavi in ordine crescente ricostruendo ogni chiave dagli archi
+         * del cammino; il riferimento ritornato da operator* resta valido fino
+         * all'incremento successivo
+         */
+        class const_iterator{
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef std::string               value_type;
+                typedef std::ptrdiff_t            difference_type;
+                typedef const std::string*        pointer;
+                typedef const std::string&        reference;
+
+                /**
+                 * @brief Costruttore di default
+                 *
+                 */
+                const_iterator(): _ptr(nullptr), _limit(nullptr){}
+
+                reference operator*() const{
+                    return _key;
+                }
+
+                pointer operator->() const{
+                    return &_key;
+                }
+
+                const_iterator& operator++(){
+                    advance();
+                    return *this;
+                }
+
+                const_iterator operator++(int){
+                    const_iterator tmp(*this);
+                    advance();
+                    return tmp;
+                }
+
+                bool operator==(const const_iterator &other) const{
+                    return _ptr == other._ptr;
+                }
+
+                bool operator!=(const const_iterator &other) const{
+                    return !(*this == other);
+                }
+
+            private:
+                friend class radix_tree;///< friend della classe radix_tree
+                const node* _ptr;///< nodo della chiave corrente (nullptr alla fine)
+                const node* _limit;///< radice del sotto-albero visitato
+                std::string _key;///< chiave corrente, concatenazione degli archi dalla radice
+
+                /**
+                 * @brief Costruttore privato: si posiziona sulla prima chiave del sotto-albero
+                 *
+                 * @param start radice del sotto-albero da visitare
+                 * @param limit nodo oltre il quale la visita non risale
+                 * @param key chiave corrispondente al cammino fino a start
+                 */
+                const_iterator(const node *start, const node *limit, const std::string &key): _ptr(start), _limit(limit), _key(key){
+                    if(!_ptr->terminal)
+                        advance();
+                }
+
+                /**
+                 * @brief Funzione che sposta l'iteratore sulla chiave successiva
+                 * (visita in profondità: un nodo precede i propri figli)
+                 */
+                void advance(){
+                    do{
+                        step();
+                    }while(_ptr != nullptr && !_ptr->terminal);
+                }
+
+                /**
+                 * @brief Funzione che sposta l'iteratore sul nodo successivo della visita
+                 */
+                void step(){
+                    if(!_ptr->children.empty()){
+                        _ptr = _ptr->children.front();
+                        _key += _ptr->label;
+                        return;
+                    }
+                    while(_ptr != _limit){
+                        const node* p = _ptr->parent;
+                        std::vector<node*>::const_iterator next = child_position(p, _ptr->label[0]) + 1;
+                        _key.erase(_key.size() - _ptr->label.size());
+                        if(next != p->children.end()){
+                            _ptr = *next;
+                            _key += _ptr->label;
+                            return;
+                        }
+                        _ptr = p;
+                    }
+                    _ptr = nullptr;
+                }
+        };
+
+        /**
+         * @brief Iteratore di inizio
+         *
+         * @return const_iterator
+         */
+        const_iterator begin() const{
+            return const_iterator(&_root, &_root, "");
+        }
+
+        /**
+         * @brief Iteratore di fine
+         *
+         * @return const_iterator
+         */
+        const_iterator end() const{
+            return const_iterator();
+        }
+
+        /**
+         * @brief Operatore di stream
+         *
+         * @param os stream di output
+         * @param tree albero da spedire sullo stream
+         * @return std::ostream& reference dello stream di output
+         */
+        friend std::ostream& operator<<(std::ostream &os, const radix_tree &tree){
+            for(const_iterator b = tree.begin(), e = tree.end(); b != e; ++b)
+                os<<*b<<" ";
+            return os;
+        }
+};
+
+#endif
@@ -0,0 +1,610 @@
+#ifndef SHARDED_TREE_H
+#define SHARDED_TREE_H
+#include <algorithm>
+#include <ostream>
+#include <iterator>  // std::forward_iterator_tag
+#include <cstddef>   // std::ptrdiff_t, std::size_t
+#include <vector>
+#include <memory>    // std::unique_ptr
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional> // std::hash
+#include "binary_search_tree.h"
+
+/**
+ * @brief Classe sharded_tree
+ *
+ * Contenitore ordinato che divide lo spazio delle chiavi in intervalli consecutivi,
+ * ognuno memorizzato in un proprio binary_search_tree (shard) con un proprio mutex,
+ * una propria radice e propri nodi: scritture su intervalli diversi procedono in
+ * parallelo su core diversi. Quando uno shard supera max_imbalance volte la
+ * dimensione media i valori vengono ridistribuiti in intervalli di uguale
+ * dimensione (repartition), costruendo ogni shard con add_batch.
+ *
+ * add, try_add, remove, contains, count e size possono essere chiamate da più
+ * thread insieme: leggono la divisione corrente da un puntatore atomico senza
+ * lock globali né contatori di riferimenti condivisi, e bloccano solo il mutex
+ * dello shard scelto. Le divisioni sostituite da una repartition o da clear
+ * vengono svuotate subito e liberate appena nessun thread può più leggerle:
+ * mentre legge il puntatore ogni thread si registra in uno di reader_slots
+ * contatori, scelto dal suo id, così thread diversi non si contendono la
+ * stessa linea di cache. La visita con const_iterator, la copia e l'assegnamento
+ * richiedono invece che nessun thread stia scrivendo, e una repartition invalida
+ * gli iteratori esistenti
+ *
+ * @tparam T tipo dei valori
+ * @tparam Eql funtore di eguaglianza
+ * @tparam Comp funtore di comparazione
+ * @tparam Policy politiche degli shard (vedi tree_policy)
+ */
+template<typename T, typename Eql, typename Comp, typename Policy = tree_policy>
+class sharded_tree{
+    public:
+        typedef binary_search_tree<T, Eql, Comp, Policy> tree_type;///< tipo degli shard
+
+    private:
+        /**
+         * @brief Shard: un intervallo di chiavi con il suo albero e il suo mutex
+         */
+        struct shard{
+            tree_type tree;///< valori dell'intervallo
+            std::mutex mutex;///< protegge tree
+            std::atomic<std::size_t> size;///< copia di tree.size() leggibile senza mutex
+
+            shard(): size(0){}
+        };
+
+        /**
+         * @brief Divisione dello spazio delle chiavi: lo shard i contiene i valori
+         * v con bounds[i - 1] <= v < bounds[i]
+         *
+         * Non cambia mai dopo la pubblicazione: una repartition crea una nuova layout
+         */
+        struct layout{
+            std::vector<T> bounds;///< estremi degli intervalli, strettamente crescenti
+            std::vector<std::unique_ptr<shard> > shards;///< bounds.size() + 1 shard
+        };
+
+        /**
+         * @brief Contatore dei thread che stanno leggendo una divisione, su una
+         * propria linea di cache
+         */
+        struct alignas(64) reader_slot{
+            std::atomic<std::size_t> count;
+
+            reader_slot(): count(0){}
+        };
+
+        /**
+         * @brief Registrazione di un thread come lettore della divisione corrente
+         * per la durata dello scope
+         */
+        class reading{
+            std::atomic<std::size_t> &_count;
+
+            reading(const reading&);
+            reading& operator=(const reading&);
+
+            public:
+                explicit reading(const sharded_tree &st): _count(st.slot().count){
+                    _count.fetch_add(1);
+                }
+
+                ~reading(){
+                    _count.fetch_sub(1);
+                }
+        };
+
+        /**
+         * @brief Numero dei contatori dei lettori
+         */
+        static const std::size_t reader_slots = 16;
+
+        std::atomic<layout*> _layout;///< divisione corrente
+        std::vector<std::unique_ptr<layout> > _layouts;///< divisioni non ancora liberate, la corrente in fondo (modificato con _repartition acquisito)
+        mutable reader_slot _readers[reader_slots];///< thread che stanno leggendo _layout, per contatore
+        std::atomic<std::size_t> _size;///< somma delle dimensioni degli shard
+        unsigned int _shards;///< numero di shard desiderato
+        double _max_imbalance;///< rapporto massimo tra lo shard più grande e la dimensione media
+        std::mutex _repartition;///< serializza le repartition
+        Comp _compare;///< funtore di comparazione
+
+        /**
+         * @brief Numero minimo di valori per shard sotto il quale non si ridistribuisce
+         */
+        static const std::size_t min_shard_size = 1024;
+
+        /**
+         * @brief Funzione che ritorna il contatore dei lettori del thread chiamante
+         */
+        reader_slot& slot() const{
+            static thread_local std::size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % reader_slots;
+            return _readers[index];
+        }
+
+        /**
+         * @brief Funzione che ritorna lo shard che contiene l'intervallo di un valore
+         *
+         * @param l divisione da usare
+         * @param value valore da cercare
+         * @return shard& shard responsabile del valore
+         */
+        shard& route(const layout &l, const T &value) const{
+            return *l.shards[std::upper_bound(l.bounds.begin(), l.bounds.end(), value, _compare) - l.bounds.begin()];
+        }
+
+        /**
+         * @brief Funzione che blocca lo shard responsabile di un valore
+         *
+         * Se una repartition sostituisce la divisione tra la scelta dello shard e
+         * l'acquisizione del mutex il tentativo viene ripetuto sulla nuova divisione;
+         * finché il mutex è tenuto la divisione non può cambiare, quindi il thread
+         * resta registrato come lettore solo fino alla verifica
+         *
+         * @param value valore da cercare
+         * @param lock lock acquisito sul mutex dello shard
+         * @return shard& shard bloccato
+         */
+        shard& lock_shard(const T &value, std::unique_lock<std::mutex> &lock) const{
+            reading guard(*this);
+            while(true){
+                const layout* l = _layout.load();
+                shard &s = route(*l, value);
+                lock = std::unique_lock<std::mutex>(s.mutex);
+                if(_layout.load() == l)
+                    return s;
+                lock.unlock();
+            }
+        }
+
+        /**
+         * @brief Funzione che rende corrente una nuova divisione
+         *
+         * Richiede _repartition acquisito (o nessun altro thread attivo)
+         *
+         * @param l divisione da pubblicare
+         *
+         * @throw std::bad_alloc eccezione durante la registrazione (la divisione corrente resta in uso)
+         */
+        void publish(std::unique_ptr<layout> l){
+            _layouts.push_back(std::move(l));
+            _layout.store(_layouts.back().get());
+        }
+
+        /**
+         * @brief Funzione che libera le divisioni sostituite se nessun thread le sta
+         * leggendo; altrimenti restano (vuote) fino alla prossima sostituzione
+         *
+         * Richiede _repartition acquisito e nessun mutex degli shard sostituiti:
+         * un thread che si registra dopo aver trovato il suo contatore a zero legge
+         * già la divisione corrente (tutte le operazioni sono sequenzialmente consistenti)
+         */
+        void reclaim(){
+            if(_layouts.size() == 1)
+                return;
+            for(std::size_t i = 0; i < reader_slots; ++i)
+                if(_readers[i].count.load() != 0)
+                    return;
+            _layouts.erase(_layouts.begin(), _layouts.end() - 1);
+        }
+
+        /**
+         * @brief Funzione che svuota gli shard di una divisione appena sostituita,
+         * con tutti i loro mutex acquisiti: nessun thread li userà più
+         *
+         * @param old divisione sostituita
+         */
+        static void retire(layout &old){
+            for(std::size_t i = 0; i < old.shards.size(); ++i){
+                old.shards[i]->tree.clear();
+                old.shards[i]->size = 0;
+            }
+        }
+
+        /**
+         * @brief Funzione che aggiorna la dimensione dello shard e del contenitore
+         * dopo una modifica, con il mutex dello shard acquisito
+         *
+         * @param s shard modificato
+         * @return true se lo shard è diventato troppo grande rispetto alla media
+         */
+        bool update_size(shard &s){
+            std::size_t before = s.size.load(std::memory_order_relaxed);
+            std::size_t after = s.tree.size();
+            s.size.store(after, std::memory_order_relaxed);
+            std::size_t total = after >= before ? _size.fetch_add(after - before) + (after - before)
+                                                : _size.fetch_sub(before - after) - (before - after);
+            return after >= min_shard_size && after * _shards > _max_imbalance * total;
+        }
+
+        /**
+         * @brief Funzione che copia in values, in ordine, tutti i valori di una
+         * divisione (in modalità multi_keys ogni copia compare una volta)
+         *
+         * Richiede che tutti i mutex degli shard siano acquisiti
+         */
+        static void collect(const layout &l, std::vector<T> &values){
+            for(std::size_t i = 0; i < l.shards.size(); ++i){
+                const tree_type &t = l.shards[i]->tree;
+                for(typename tree_type::const_iterator b = t.begin(), e = t.end(); b != e; ++b)
+                    values.insert(values.end(), t.count(*b), *b);
+            }
+        }
+
+        /**
+         * @brief Funzione che crea una divisione in parti uguali di valori ordinati
+         *
+         * @param values valori in ordine
+         * @return std::unique_ptr<layout> nuova divisione con al più _shards shard
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione di shard e nodi
+         */
+        std::unique_ptr<layout> split(const std::vector<T> &values) const{
+            std::unique_ptr<layout> l(new layout());
+            for(unsigned int i = 1; i < _shards && !values.empty(); ++i){
+                const T &bound = values[values.size() * i / _shards];
+                if(l->bounds.empty() ? _compare(values.front(), bound) : _compare(l->bounds.back(), bound))
+                    l->bounds.push_back(bound);
+            }
+            typename std::vector<T>::const_iterator first = values.begin();
+            for(std::size_t i = 0; i <= l->bounds.size(); ++i){
+                typename std::vector<T>::const_iterator last = i < l->bounds.size()
+                    ? std::lower_bound(first, values.end(), l->bounds[i], _compare) : values.end();
+                l->shards.push_back(std::unique_ptr<shard>(new shard()));
+                l->shards.back()->tree.add_batch(first, last);
+                l->shards.back()->size = l->shards.back()->tree.size();
+                first = last;
+            }
+            return l;
+        }
+
+        /**
+         * @brief Funzione che ridistribuisce i valori se uno shard è ancora troppo
+         * grande; se un'altra repartition è in corso ritorna subito
+         */
+        void rebalance(){
+            std::unique_lock<std::mutex> guard(_repartition, std::try_to_lock);
+            if(!guard.owns_lock())
+                return;
+            layout* current = _layout.load();
+            std::size_t total = _size.load();
+            for(std::size_t i = 0; i < current->shards.size(); ++i){
+                std::size_t s = current->shards[i]->size.load(std::memory_order_relaxed);
+                if(s >= min_shard_size && s * _shards > _max_imbalance * total){
+                    repartition_locked(*current);
+                    return;
+                }
+            }
+        }
+
+        /**
+         * @brief Funzione che sostituisce la divisione corrente con una in parti uguali
+         *
+         * Richiede _repartition acquisito. Gli shard vengono bloccati in ordine
+         * (le scritture ne bloccano uno alla volta, quindi non c'è stallo)
+         *
+         * @param current divisione corrente
+         *
+         * @throw std::bad_alloc eccezione durante la costruzione (la divisione corrente resta in uso)
+         */
+        void repartition_locked(layout &current){
+            std::vector<std::unique_lock<std::mutex> > locks;
+            for(std::size_t i = 0; i < current.shards.size(); ++i)
+                locks.push_back(std::unique_lock<std::mutex>(current.shards[i]->mutex));
+            std::vector<T> values;
+            values.reserve(_size.load());
+            collect(current, values);
+            publish(split(values));
+            retire(current);
+            locks.clear();
+            reclaim();
+        }
+
+    public:
+        /**
+         * @brief Costruttore
+         *
+         * Il contenitore parte con un solo shard e si divide quando raggiunge
+         * min_shard_size valori per shard
+         *
+         * @param shards numero di shard (0 per il numero di core disponibili)
+         * @param max_imbalance rapporto tra lo shard più grande e la dimensione media
+         * oltre il quale i valori vengono ridistribuiti (almeno 1.5)
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione del primo shard
+         */
+        explicit sharded_tree(unsigned int shards = 0, double max_imbalance = 2.0)
+            : _layout(nullptr), _size(0), _shards(shards), _max_imbalance(max_imbalance){
+            if(_shards == 0)
+                _shards = std::max(1u, std::thread::hardware_concurrency());
+            if(!(_max_imbalance >= 1.5))
+                _max_imbalance = 1.5;
+            publish(split(std::vector<T>()));
+        }
+
+        /**
+         * @brief Copy constructor: copia valori e divisione
+         *
+         * @param other contenitore da copiare (senza scritture in corso)
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione dei nodi
+         */
+        sharded_tree(const sharded_tree &other)
+            : _layout(nullptr), _size(other._size.load()), _shards(other._shards),
+              _max_imbalance(other._max_imbalance), _compare(other._compare){
+            const layout &source = *other._layout.load();
+            std::unique_ptr<layout> l(new layout());
+            l->bounds = source.bounds;
+            for(std::size_t i = 0; i < source.shards.size(); ++i){
+                l->shards.push_back(std::unique_ptr<shard>(new shard()));
+                l->shards.back()->tree = source.shards[i]->tree;
+                l->shards.back()->size = source.shards[i]->tree.size();
+            }
+            publish(std::move(l));
+        }
+
+        /**
+         * @brief Operatore di assegnamento
+         *
+         * @param other contenitore da copiare (senza scritture in corso su entrambi)
+         * @return sharded_tree& reference a this
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione dei nodi (this resta invariato)
+         */
+        sharded_tree& operator=(const sharded_tree &other){
+            if(this != &other){
+                sharded_tree tmp(other);
+                std::swap(_layouts, tmp._layouts);
+                _layout.store(_layouts.back().get());
+                _size = tmp._size.load();
+                _shards = tmp._shards;
+                _max_imbalance = tmp._max_imbalance;
+                std::swap(_compare, tmp._compare);
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Funzione che aggiunge un valore
+         *
+         * @param value valore da aggiungere
+         *
+         * @throw existing_node_exception eccezione lanciata se il valore già esiste (solo unique_keys)
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        void add(const T &value){
+            bool unbalanced;
+            {
+                std::unique_lock<std::mutex> lock;
+                shard &s = lock_shard(value, lock);
+                s.tree.add(value);
+                unbalanced = update_size(s);
+            }
+            if(unbalanced)
+                rebalance();
+        }
+
+        /**
+         * @brief Funzione che aggiunge un valore senza lanciare eccezioni per i valori
+         * già presenti (vedi binary_search_tree::try_add)
+         *
+         * @param value valore da aggiungere
+         * @return typename tree_type::add_result esito dell'inserimento
+         *
+         * @throw std::bad_alloc eccezione durante l'allocazione di un nodo
+         */
+        typename tree_type::add_result try_add(const T &value){
+            typename tree_type::add_result result;
+            bool unbalanced;
+            {
+                std::unique_lock<std::mutex> lock;
+                shard &s = lock_shard(value, lock);
+                result = s.tree.try_add(value);
+                unbalanced = update_size(s);
+            }
+            if(unbalanced)
+                rebalance();
+            return result;
+        }
+
+        /**
+         * @brief Funzione che rimuove un valore, con tutte le sue copie
+         *
+         * @param value valore da rimuovere
+         * @return true se il valore era presente ed è stato rimosso
+         * @return false se il valore non era presente
+         */
+        bool remove(const T &value){
+            std::unique_lock<std::mutex> lock;
+            shard &s = lock_shard(value, lock);
+            bool removed = s.tree.remove(value);
+            update_size(s);
+            return removed;
+        }
+
+        /**
+         * @brief Funzione che verifica se un valore è presente
+         *
+         * @param value valore da cercare
+         * @return true se il valore è presente
+         * @return false altrimenti
+         */
+        bool contains(const T &value) const{
+            std::unique_lock<std::mutex> lock;
+            return lock_shard(value, lock).tree.contains(value);
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero di copie di un valore
+         *
+         * @param value valore da cercare
+         * @return std::size_t numero di copie (0 se il valore non è presente)
+         */
+        std::size_t count(const T &value) const{
+            std::unique_lock<std::mutex> lock;
+            return lock_shard(value, lock).tree.count(value);
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero dei valori di tutti gli shard
+         *
+         * @return std::size_t numero dei valori
+         */
+        std::size_t size() const{
+            return _size.load();
+        }
+
+        /**
+         * @brief Funzione che verifica se il contenitore è vuoto
+         *
+         * @return true se non contiene valori
+         * @return false altrimenti
+         */
+        bool empty() const{
+            return size() == 0;
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero di shard della divisione corrente
+         * (al più quello richiesto al costruttore; meno se i valori sono pochi)
+         *
+         * @return std::size_t numero di shard
+         */
+        std::size_t shard_count() const{
+            reading guard(*this);
+            return _layout.load()->shards.size();
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero di valori di uno shard
+         *
+         * @param i indice dello shard (minore di shard_count())
+         * @return std::size_t numero di valori dello shard
+         */
+        std::size_t shard_size(std::size_t i) const{
+            reading guard(*this);
+            return _layout.load()->shards[i]->size.load();
+        }
+
+        /**
+         * @brief Funzione che ridistribuisce subito i valori in shard di uguale dimensione
+         *
+         * @throw std::bad_alloc eccezione durante la costruzione (la divisione corrente resta in uso)
+         */
+        void repartition(){
+            std::lock_guard<std::mutex> guard(_repartition);
+            repartition_locked(*_layout.load());
+        }
+
+        /**
+         * @brief Funzione che rimuove tutti i valori e torna a un solo shard
+         *
+         */
+        void clear(){
+            std::lock_guard<std::mutex> guard(_repartition);
+            layout &current = *_layout.load();
+            std::vector<std::unique_lock<std::mutex> > locks;
+            for(std::size_t i = 0; i < current.shards.size(); ++i)
+                locks.push_back(std::unique_lock<std::mutex>(current.shards[i]->mutex));
+            // con i mutex acquisiti _size conta solo i valori da rimuovere; dopo la
+            // pubblicazione altri thread possono già aggiornarlo, quindi si sottrae
+            std::size_t removed = _size.load();
+            publish(split(std::vector<T>()));
+            retire(current);
+            _size.fetch_sub(removed);
+            locks.clear();
+            reclaim();
+        }
+
+        /**
+         * @brief Iteratore costante in ordine su tutti i valori: visita gli shard
+         * uno dopo l'altro, che contengono intervalli consecutivi di chiavi
+         */
+        class const_iterator{
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef ptrdiff_t difference_type;
+                typedef const T* pointer;
+                typedef const T& reference;
+
+                const_iterator(): _layout(nullptr), _shard(0){}
+
+                reference operator*() const{
+                    return *_it;
+                }
+
+                pointer operator->() const{
+                    return &(*_it);
+                }
+
+                const_iterator& operator++(){
+                    ++_it;
+                    skip_empty();
+                    return *this;
+                }
+
+                const_iterator operator++(int){
+                    const_iterator tmp(*this);
+                    ++*this;
+                    return tmp;
+                }
+
+                bool operator==(const const_iterator &other) const{
+                    return _shard == other._shard && _it == other._it;
+                }
+
+                bool operator!=(const const_iterator &other) const{
+                    return !(*this == other);
+                }
+
+            private:
+                friend class sharded_tree;
+
+                const layout* _layout;///< divisione visitata
+                std::size_t _shard;///< indice dello shard corrente
+                typename tree_type::const_iterator _it;///< posizione nello shard corrente
+
+                const_iterator(const layout *l, std::size_t shard, typename tree_type::const_iterator it)
+                    : _layout(l), _shard(shard), _it(it){
+                    skip_empty();
+                }
+
+                /**
+                 * @brief Passa al primo valore degli shard successivi quando lo shard
+                 * corrente è finito (l'ultimo shard finito è end())
+                 */
+                void skip_empty(){
+                    while(_shard + 1 < _layout->shards.size() && _it == _layout->shards[_shard]->tree.end()){
+                        ++_shard;
+                        _it = _layout->shards[_shard]->tree.begin();
+                    }
+                }
+        };
+
+        const_iterator begin() const{
+            const layout* l = _layout.load();
+            return const_iterator(l, 0, l->shards.front()->tree.begin());
+        }
+
+        const_iterator end() const{
+            const layout* l = _layout.load();
+            return const_iterator(l, l->shards.size() - 1, l->shards.back()->tree.end());
+        }
+
+        /**
+         * @brief Operatore di stream: i valori in ordine separati da spazi
+         *
+         * @param os stream di output
+         * @param st contenitore da spedire sullo stream
+         * @return std::ostream& reference dello stream di output
+         */
+        friend std::ostream& operator<<(std::ostream &os, const sharded_tree &st){
+            for(const_iterator b = st.begin(), e = st.end(); b != e; ++b)
+                os << *b << " ";
+            return os;
+        }
+};
+
+#endif
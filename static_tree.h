@@ -0,0 +1,305 @@
+#ifndef STATIC_TREE_H
+#define STATIC_TREE_H
+#include <ostream>
+#include <iterator>  // std::forward_iterator_tag
+#include <cstddef>   // std::ptrdiff_t, std::size_t
+#include "existing_node_exception.h"
+#include "bst_exceptions.h"
+
+/**
+ * @brief Sequenza di indici 0, 1, ..., N - 1 usata per inizializzare un array
+ * con un'espansione di pacchetto
+ */
+template<std::size_t... I>
+struct index_list{};
+
+template<typename A, typename B>
+struct concat_index_list;
+
+template<std::size_t... I, std::size_t... J>
+struct concat_index_list<index_list<I...>, index_list<J...> >{
+    typedef index_list<I..., (sizeof...(I) + J)...> type;
+};
+
+/**
+ * @brief Costruisce index_list<0, ..., N - 1> unendo due metà, con profondità
+ * di istanziazione logaritmica in N
+ */
+template<std::size_t N>
+struct make_index_list : concat_index_list<typename make_index_list<N / 2>::type, typename make_index_list<N - N / 2>::type>{};
+
+template<>
+struct make_index_list<0>{
+    typedef index_list<> type;
+};
+
+template<>
+struct make_index_list<1>{
+    typedef index_list<0> type;
+};
+
+/**
+ * @brief Classe static_tree
+ *
+ * Albero binario di ricerca immutabile per insiemi di chiavi noti in compilazione.
+ * Le chiavi sono memorizzate nell'oggetto stesso in ordine di Eytzinger (il nodo k
+ * ha i figli in 2k + 1 e 2k + 2): l'albero è completo e bilanciato, non ha
+ * puntatori né nodi sullo heap e la ricerca scorre un array contiguo.
+ * Il costruttore è constexpr: con un oggetto constexpr la costruzione avviene in
+ * compilazione e all'avvio non viene eseguito codice. Le chiavi possono essere
+ * passate in qualsiasi ordine; per la costruzione in compilazione operator() di
+ * Eql e Comp deve essere constexpr. Il costo della costruzione è quadratico in N,
+ * quindi è pensato per tabelle di qualche centinaio di chiavi (con g++ fino a
+ * circa 500 senza alzare -fconstexpr-ops-limit)
+ *
+ * @tparam T tipo delle chiavi (tipo letterale)
+ * @tparam N numero delle chiavi
+ * @tparam Eql funtore di eguaglianza
+ * @tparam Comp funtore di comparazione
+ */
+template<typename T, std::size_t N, typename Eql, typename Comp>
+class static_tree{
+    static_assert(N > 0, "a static_tree needs at least one key");
+
+    T _keys[N];///< chiavi in ordine di Eytzinger
+    Eql _equals;///< funtore di eguaglianza
+    Comp _compare;///< funtore di comparazione
+
+    /**
+     * @brief Numero dei nodi del sotto-albero con radice nell'indice k
+     */
+    static constexpr std::size_t subtree_size(std::size_t k){
+        return k >= N ? 0 : 1 + subtree_size(2 * k + 1) + subtree_size(2 * k + 2);
+    }
+
+    /**
+     * @brief Posizione nella visita in ordine del nodo con indice k
+     */
+    static constexpr std::size_t rank(std::size_t k){
+        return k == 0 ? subtree_size(1)
+             : k % 2 == 1 ? rank((k - 1) / 2) - 1 - subtree_size(2 * k + 2)
+             : rank((k - 1) / 2) + 1 + subtree_size(2 * k + 1);
+    }
+
+    /**
+     * @brief Numero delle chiavi di keys[lo, hi) che precedono keys[i]
+     *
+     * Le funzioni di costruzione dividono gli intervalli a metà, così la
+     * profondità della ricorsione constexpr resta logaritmica
+     */
+    static constexpr std::size_t count_less(const T (&keys)[N], std::size_t i, std::size_t lo, std::size_t hi){
+        return hi - lo == 1 ? (Comp()(keys[lo], keys[i]) ? 1 : 0)
+             : count_less(keys, i, lo, lo + (hi - lo) / 2) + count_less(keys, i, lo + (hi - lo) / 2, hi);
+    }
+
+    /**
+     * @brief Posizione di ogni chiave nell'ordine di Comp, calcolata una volta sola
+     */
+    struct rank_table{
+        std::size_t of[N];///< of[i] = numero delle chiavi che precedono keys[i]
+
+        template<std::size_t... I>
+        constexpr rank_table(const T (&keys)[N], index_list<I...>): of{count_less(keys, I, 0, N)...}{}
+    };
+
+    /**
+     * @brief Indice in [lo, hi) della chiave in posizione r (N se nessuna chiave ha
+     * quella posizione, il che accade solo con chiavi equivalenti)
+     */
+    static constexpr std::size_t index_of(const rank_table &ranks, std::size_t r, std::size_t lo, std::size_t hi){
+        return hi - lo == 1 ? (ranks.of[lo] == r ? lo : N)
+             : first_found(index_of(ranks, r, lo, lo + (hi - lo) / 2), ranks, r, lo + (hi - lo) / 2, hi);
+    }
+
+    static constexpr std::size_t first_found(std::size_t found, const rank_table &ranks, std::size_t r, std::size_t lo, std::size_t hi){
+        return found != N ? found : index_of(ranks, r, lo, hi);
+    }
+
+    /**
+     * @brief Chiave di indice i
+     *
+     * @throw existing_node_exception eccezione lanciata se le chiavi contengono duplicati
+     * (in compilazione diventa un errore, senza eccezioni termina con std::abort)
+     */
+    static constexpr T key_at(const T (&keys)[N], std::size_t i){
+        return i == N ? (BST_THROW(existing_node_exception("Cannot insert an existing node in the static tree")), keys[0])
+             : keys[i];
+    }
+
+    /**
+     * @brief Costruttore che dispone le chiavi: nel nodo k va la chiave di posizione rank(k)
+     */
+    template<std::size_t... I>
+    constexpr static_tree(const T (&keys)[N], const rank_table &ranks, index_list<I...>)
+        : _keys{key_at(keys, index_of(ranks, rank(I), 0, N))...}, _equals(), _compare(){}
+
+    /**
+     * @brief Ricerca a partire dal nodo con indice k
+     */
+    constexpr std::size_t find_index(const T &value, std::size_t k) const{
+        return k >= N ? N
+             : _equals(_keys[k], value) ? k
+             : find_index(value, _compare(value, _keys[k]) ? 2 * k + 1 : 2 * k + 2);
+    }
+
+    /**
+     * @brief Indice del nodo più a sinistra del sotto-albero con radice k
+     */
+    static constexpr std::size_t leftmost(std::size_t k){
+        return 2 * k + 1 < N ? leftmost(2 * k + 1) : k;
+    }
+
+    public:
+        /**
+         * @brief Costruttore constexpr
+         *
+         * @param keys chiavi, in qualsiasi ordine
+         *
+         * @throw existing_node_exception eccezione lanciata se le chiavi contengono duplicati
+         */
+        constexpr explicit static_tree(const T (&keys)[N])
+            : static_tree(keys, rank_table(keys, typename make_index_list<N>::type()), typename make_index_list<N>::type()){}
+
+        /**
+         * @brief Funzione che verifica se un valore è presente (utilizzabile in compilazione)
+         *
+         * @param value valore da cercare
+         * @return true se il valore è presente
+         * @return false altrimenti
+         */
+        constexpr bool contains(const T &value) const{
+            return find_index(value, 0) != N;
+        }
+
+        /**
+         * @brief Funzione che ritorna il numero delle chiavi
+         *
+         * @return std::size_t N
+         */
+        constexpr std::size_t size() const{
+            return N;
+        }
+
+        /**
+         * @brief Funzione che verifica se l'albero è vuoto
+         *
+         * @return false sempre: un static_tree ha almeno una chiave
+         */
+        constexpr bool empty() const{
+            return false;
+        }
+
+        /**
+         * @brief Funzione che ritorna il valore minimo
+         *
+         * @return const T& chiave minima
+         */
+        constexpr const T& min() const{
+            return _keys[leftmost(0)];
+        }
+
+        /**
+         * @brief Iteratore costante: visita le chiavi in ordine muovendosi tra gli
+         * indici dell'albero implicito
+         */
+        class const_iterator{
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef ptrdiff_t difference_type;
+                typedef const T* pointer;
+                typedef const T& reference;
+
+                const_iterator(): _keys(nullptr), _index(N){}
+
+                reference operator*() const{
+                    return _keys[_index];
+                }
+
+                pointer operator->() const{
+                    return &_keys[_index];
+                }
+
+                const_iterator& operator++(){
+                    if(2 * _index + 2 < N){
+                        _index = leftmost(2 * _index + 2);
+                    }else{
+                        // risale finché il nodo è un figlio destro
+                        while(_index != 0 && _index % 2 == 0)
+                            _index = (_index - 1) / 2;
+                        _index = _index == 0 ? N : (_index - 1) / 2;
+                    }
+                    return *this;
+                }
+
+                const_iterator operator++(int){
+                    const_iterator tmp(*this);
+                    ++*this;
+                    return tmp;
+                }
+
+                bool operator==(const const_iterator &other) const{
+                    return _index == other._index;
+                }
+
+                bool operator!=(const const_iterator &other) const{
+                    return !(*this == other);
+                }
+
+            private:
+                friend class static_tree;
+
+                const T* _keys;///< chiavi dell'albero
+                std::size_t _index;///< indice del nodo corrente (N per end())
+
+                const_iterator(const T *keys, std::size_t index): _keys(keys), _index(index){}
+        };
+
+        const_iterator begin() const{
+            return const_iterator(_keys, leftmost(0));
+        }
+
+        const_iterator end() const{
+            return const_iterator(_keys, N);
+        }
+
+        /**
+         * @brief Funzione che cerca un valore
+         *
+         * @param value valore da cercare
+         * @return const_iterator iteratore al valore (end() se non presente)
+         */
+        const_iterator find(const T &value) const{
+            return const_iterator(_keys, find_index(value, 0));
+        }
+
+        /**
+         * @brief Operatore di stream: le chiavi in ordine separate da spazi
+         *
+         * @param os stream di output
+         * @param st albero da spedire sullo stream
+         * @return std::ostream& reference dello stream di output
+         */
+        friend std::ostream& operator<<(std::ostream &os, const static_tree &st){
+            for(const_iterator b = st.begin(), e = st.end(); b != e; ++b)
+                os << *b << " ";
+            return os;
+        }
+};
+
+/**
+ * @brief Funzione che costruisce uno static_tree deducendo tipo e numero delle chiavi
+ *
+ * Esempio: constexpr auto codes = make_static_tree<equals, compare>(table);
+ *
+ * @param keys array delle chiavi, in qualsiasi ordine
+ * @return static_tree albero con le chiavi
+ *
+ * @throw existing_node_exception eccezione lanciata se le chiavi contengono duplicati
+ */
+template<typename Eql, typename Comp, typename T, std::size_t N>
+constexpr static_tree<T, N, Eql, Comp> make_static_tree(const T (&keys)[N]){
+    return static_tree<T, N, Eql, Comp>(keys);
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef TREE_EXPORT_H
+#define TREE_EXPORT_H
+#include <future>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "binary_search_tree.h"
+
+/**
+ * @brief Funtore che scrive su file i valori di uno snapshot, uno per riga
+ *
+ * @tparam T tipo dei valori
+ */
+template<typename T>
+class file_sink{
+    std::shared_ptr<std::ofstream> _out;///< file di output (condiviso tra le copie del funtore)
+    std::string _path;///< percorso del file, per i messaggi di errore
+
+    public:
+        /**
+         * @brief Costruttore: apre il file in scrittura
+         *
+         * @param path percorso del file
+         *
+         * @throw std::runtime_error eccezione lanciata se il file non può essere aperto
+         */
+        explicit file_sink(const std::string &path): _out(new std::ofstream(path.c_str())), _path(path){
+            if(!*_out)
+                throw std::runtime_error("Cannot open " + path + " for writing");
+        }
+
+        /**
+         * @brief Operatore che scrive un valore
+         *
+         * @throw std::runtime_error eccezione lanciata se lo stream è in errore
+         */
+        void operator()(const T &value){
+            *_out << value << '\n';
+            if(!_out->good())
+                throw std::runtime_error("Cannot write " + _path);
+        }
+
+        /**
+         * @brief Funzione che svuota il buffer e chiude il file
+         *
+         * @throw std::runtime_error eccezione lanciata se la scrittura o la chiusura falliscono
+         */
+        void close(){
+            _out->flush();
+            bool written = _out->good();
+            _out->close();
+            if(!written || _out->fail())
+                throw std::runtime_error("Cannot write " + _path);
+        }
+};
+
+/**
+ * @brief Funzione chiamata da export_async dopo l'ultimo valore: i sink generici
+ * non hanno nulla da chiudere
+ */
+template<typename Sink>
+void close_sink(Sink &){}
+
+/**
+ * @brief Funzione che chiude un file_sink, così gli errori di scrittura
+ * arrivano al future invece di andare persi nel distruttore dello stream
+ */
+template<typename T>
+void close_sink(file_sink<T> &sink){
+    sink.close();
+}
+
+/**
+ * @brief Funzione che esporta il contenuto di un albero in background
+ *
+ * Il chiamante cattura uno snapshot consistente copiando i valori, in ordine,
+ * in un unico vettore: è l'unico momento in cui l'albero deve restare fermo
+ * (ed eventualmente protetto dal lock esterno). La scrittura verso sink
+ * avviene poi su un thread separato mentre l'albero può essere modificato
+ *
+ * @tparam T tipo dei valori nell'albero
+ * @tparam Eql funtore di uguaglianza
+ * @tparam Comp funtore di comparazione
+ * @tparam Policy politiche dell'albero
+ * @tparam Sink funtore chiamato sul thread di esportazione con ogni valore, in ordine
+ * @param bst albero da esportare
+ * @param sink destinazione dei valori
+ * @return std::future<std::size_t> numero di valori esportati; rilancia le eccezioni di sink
+ * e gli errori di scrittura su file
+ *
+ * @throw std::bad_alloc eccezione durante la copia dello snapshot
+ */
+template<typename T, typename Eql, typename Comp, typename Policy, typename Sink>
+std::future<std::size_t> export_async(const binary_search_tree<T, Eql, Comp, Policy> &bst, Sink sink){
+    std::shared_ptr<std::vector<T> > snapshot(new std::vector<T>());
+    snapshot->reserve(bst.size());
+    for(typename binary_search_tree<T, Eql, Comp, Policy>::const_iterator b = bst.begin(), e = bst.end(); b != e; ++b)
+        snapshot->push_back(*b);
+
+    return std::async(std::launch::async, [snapshot, sink]() mutable -> std::size_t {
+        for(typename std::vector<T>::const_iterator i = snapshot->begin(); i != snapshot->end(); ++i)
+            sink(*i);
+        close_sink(sink);
+        return snapshot->size();
+    });
+}
+
+/**
+ * @brief Funzione che esporta in background il contenuto di un albero su file, un valore per riga
+ *
+ * @param bst albero da esportare
+ * @param path percorso del file
+ * @return std::future<std::size_t> numero di valori esportati
+ *
+ * @throw std::runtime_error eccezione lanciata se il file non può essere aperto
+ */
+template<typename T, typename Eql, typename Comp, typename Policy>
+std::future<std::size_t> export_async(const binary_search_tree<T, Eql, Comp, Policy> &bst, const std::string &path){
+    return export_async(bst, file_sink<T>(path));
+}
+
+/**
+ * @brief Funzione che esporta in background il contenuto di un albero su file, un valore per riga
+ *
+ * @param bst albero da esportare
+ * @param path percorso del file
+ * @return std::future<std::size_t> numero di valori esportati
+ *
+ * @throw std::runtime_error eccezione lanciata se il file non può essere aperto
+ */
+template<typename T, typename Eql, typename Comp, typename Policy>
+std::future<std::size_t> export_async(const binary_search_tree<T, Eql, Comp, Policy> &bst, const char *path){
+    return export_async(bst, std::string(path));
+}
+
+#endif
@@ -0,0 +1,344 @@
+#ifndef TREE_VIEWS_H
+#define TREE_VIEWS_H
+#include <iterator> // std::forward_iterator_tag
+#include <cstddef>  // std::ptrdiff_t, std::size_t
+#include <utility>  // std::declval
+#include "binary_search_tree.h"
+
+/**
+ * @brief Classe bst_iterator_range
+ *
+ * Vista pigra su una sequenza delimitata da due iteratori. Non copia e non
+ * alloca: i valori vengono prodotti dagli iteratori solo quando vengono letti.
+ * Le viste si compongono passando una vista come sorgente di un'altra
+ *
+ * @tparam Iter tipo degli iteratori
+ */
+template<typename Iter>
+class bst_iterator_range{
+    Iter _begin;///< inizio della sequenza
+    Iter _end;///< fine della sequenza
+
+    public:
+        typedef Iter const_iterator;
+
+        /**
+         * @brief Costruttore
+         *
+         * @param b inizio della sequenza
+         * @param e fine della sequenza
+         */
+        bst_iterator_range(const Iter &b, const Iter &e): _begin(b), _end(e){}
+
+        /**
+         * @brief Iteratore di inizio
+         *
+         * @return const_iterator
+         */
+        const_iterator begin() const{
+            return _begin;
+        }
+
+        /**
+         * @brief Iteratore di fine
+         *
+         * @return const_iterator
+         */
+        const_iterator end() const{
+            return _end;
+        }
+};
+
+/**
+ * @brief Classe bst_filter_iterator
+ *
+ * Iteratore che salta i valori della sequenza sorgente che non soddisfano un predicato
+ *
+ * @tparam Iter tipo dell'iteratore sorgente
+ * @tparam P tipo del predicato
+ */
+template<typename Iter, typename P>
+class bst_filter_iterator{
+    Iter _it;///< posizione corrente nella sequenza sorgente
+    Iter _end;///< fine della sequenza sorgente
+    P _pred;///< predicato
+
+    /**
+     * @brief Sposta _it sul primo valore che soddisfa il predicato
+     *
+     */
+    void skip(){
+        while(_it != _end && !_pred(*_it))
+            ++_it;
+    }
+
+    public:
+        typedef std::forward_iterator_tag                             iterator_category;
+        typedef typename std::iterator_traits<Iter>::value_type       value_type;
+        typedef typename std::iterator_traits<Iter>::difference_type  difference_type;
+        typedef typename std::iterator_traits<Iter>::pointer          pointer;
+        typedef typename std::iterator_traits<Iter>::reference        reference;
+
+        /**
+         * @brief Costruttore
+         *
+         * @param it posizione iniziale
+         * @param end fine della sequenza sorgente
+         * @param pred predicato
+         */
+        bst_filter_iterator(const Iter &it, const Iter &end, P pred): _it(it), _end(end), _pred(pred){
+            skip();
+        }
+
+        reference operator*() const{
+            return *_it;
+        }
+
+        pointer operator->() const{
+            return &(*_it);
+        }
+
+        bst_filter_iterator& operator++(){
+            ++_it;
+            skip();
+            return *this;
+        }
+
+        bst_filter_iterator operator++(int){
+            bst_filter_iterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const bst_filter_iterator &other) const{
+            return _it == other._it;
+        }
+
+        bool operator!=(const bst_filter_iterator &other) const{
+            return !(*this == other);
+        }
+};
+
+/**
+ * @brief Classe bst_take_iterator
+ *
+ * Iteratore che si ferma dopo al più n valori della sequenza sorgente
+ *
+ * @tparam Iter tipo dell'iteratore sorgente
+ */
+template<typename Iter>
+class bst_take_iterator{
+    Iter _it;///< posizione corrente nella sequenza sorgente
+    Iter _end;///< fine della sequenza sorgente
+    std::size_t _left;///< numero di valori ancora da produrre
+
+    /**
+     * @brief Verifica se l'iteratore ha terminato la sequenza
+     *
+     * @return true se non ci sono altri valori da produrre
+     */
+    bool done() const{
+        return _left == 0 || _it == _end;
+    }
+
+    public:
+        typedef std::forward_iterator_tag                             iterator_category;
+        typedef typename std::iterator_traits<Iter>::value_type       value_type;
+        typedef typename std::iterator_traits<Iter>::difference_type  difference_type;
+        typedef typename std::iterator_traits<Iter>::pointer          pointer;
+        typedef typename std::iterator_traits<Iter>::reference        reference;
+
+        /**
+         * @brief Costruttore
+         *
+         * @param it posizione iniziale
+         * @param end fine della sequenza sorgente
+         * @param n numero massimo di valori da produrre
+         */
+        bst_take_iterator(const Iter &it, const Iter &end, std::size_t n): _it(it), _end(end), _left(n){}
+
+        reference operator*() const{
+            return *_it;
+        }
+
+        pointer operator->() const{
+            return &(*_it);
+        }
+
+        bst_take_iterator& operator++(){
+            ++_it;
+            --_left;
+            return *this;
+        }
+
+        bst_take_iterator operator++(int){
+            bst_take_iterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const bst_take_iterator &other) const{
+            if(done() || other.done())
+                return done() == other.done();
+            return _it == other._it;
+        }
+
+        bool operator!=(const bst_take_iterator &other) const{
+            return !(*this == other);
+        }
+};
+
+/**
+ * @brief Classe bst_transform_iterator
+ *
+ * Iteratore che produce il risultato di una funzione applicata ai valori della sequenza sorgente
+ *
+ * @tparam Iter tipo dell'iteratore sorgente
+ * @tparam F tipo della funzione
+ */
+template<typename Iter, typename F>
+class bst_transform_iterator{
+    Iter _it;///< posizione corrente nella sequenza sorgente
+    F _f;///< funzione da applicare
+
+    public:
+        typedef std::input_iterator_tag                               iterator_category;
+        typedef decltype(std::declval<F&>()(*std::declval<Iter>()))   value_type;
+        typedef typename std::iterator_traits<Iter>::difference_type  difference_type;
+        typedef const value_type*                                     pointer;
+        typedef value_type                                            reference;
+
+        /**
+         * @brief Costruttore
+         *
+         * @param it posizione iniziale
+         * @param f funzione da applicare
+         */
+        bst_transform_iterator(const Iter &it, F f): _it(it), _f(f){}
+
+        reference operator*() const{
+            return _f(*_it);
+        }
+
+        bst_transform_iterator& operator++(){
+            ++_it;
+            return *this;
+        }
+
+        bst_transform_iterator operator++(int){
+            bst_transform_iterator tmp(*this);
+            ++_it;
+            return tmp;
+        }
+
+        bool operator==(const bst_transform_iterator &other) const{
+            return _it == other._it;
+        }
+
+        bool operator!=(const bst_transform_iterator &other) const{
+            return !(*this == other);
+        }
+};
+
+/**
+ * @brief Vista sui valori di un albero compresi nell'intervallo [a, b)
+ *
+ * @return bst_iterator_range vista che parte dal primo valore non minore di a
+ * e si ferma al primo valore non minore di b (vuota se b non segue a)
+ */
+template<typename T, typename Eql, typename Comp, typename Policy>
+bst_iterator_range<typename binary_search_tree<T, Eql, Comp, Policy>::const_iterator>
+bst_range(const binary_search_tree<T, Eql, Comp, Policy> &bst, const T &a, const T &b){
+    typedef typename binary_search_tree<T, Eql, Comp, Policy>::const_iterator iter;
+    if(!bst.key_comp()(a, b))
+        return bst_iterator_range<iter>(bst.end(), bst.end());
+    return bst_iterator_range<iter>(bst.lower_bound(a), bst.lower_bound(b));
+}
+
+/**
+ * @brief Vista sul prefisso dei valori ordinati di un albero che soddisfa un
+ * predicato monotono (vero su un prefisso, falso sul resto)
+ *
+ * I valori successivi vengono scartati senza visitarli, quindi le riduzioni
+ * su questa vista costano quanto l'altezza più il numero dei valori che soddisfano il predicato
+ *
+ * @return bst_iterator_range vista da begin() al primo valore per cui pred è falso
+ */
+template<typename T, typename Eql, typename Comp, typename Policy, typename P>
+bst_iterator_range<typename binary_search_tree<T, Eql, Comp, Policy>::const_iterator>
+bst_prefix_while(const binary_search_tree<T, Eql, Comp, Policy> &bst, P pred){
+    typedef typename binary_search_tree<T, Eql, Comp, Policy>::const_iterator iter;
+    return bst_iterator_range<iter>(bst.begin(), bst.partition_point(pred));
+}
+
+/**
+ * @brief Vista sui valori di una sequenza che soddisfano un predicato
+ *
+ * @tparam Range tipo della sequenza (albero o vista)
+ * @tparam P tipo del predicato
+ */
+template<typename Range, typename P>
+bst_iterator_range<bst_filter_iterator<typename Range::const_iterator, P> >
+bst_filter(const Range &r, P pred){
+    typedef bst_filter_iterator<typename Range::const_iterator, P> iter;
+    return bst_iterator_range<iter>(iter(r.begin(), r.end(), pred), iter(r.end(), r.end(), pred));
+}
+
+/**
+ * @brief Vista sui primi n valori di una sequenza
+ *
+ * @tparam Range tipo della sequenza (albero o vista)
+ */
+template<typename Range>
+bst_iterator_range<bst_take_iterator<typename Range::const_iterator> >
+bst_take(const Range &r, std::size_t n){
+    typedef bst_take_iterator<typename Range::const_iterator> iter;
+    return bst_iterator_range<iter>(iter(r.begin(), r.end(), n), iter(r.end(), r.end(), 0));
+}
+
+/**
+ * @brief Vista sul risultato di una funzione applicata ai valori di una sequenza
+ *
+ * @tparam Range tipo della sequenza (albero o vista)
+ * @tparam F tipo della funzione
+ */
+template<typename Range, typename F>
+bst_iterator_range<bst_transform_iterator<typename Range::const_iterator, F> >
+bst_transform(const Range &r, F f){
+    typedef bst_transform_iterator<typename Range::const_iterator, F> iter;
+    return bst_iterator_range<iter>(iter(r.begin(), f), iter(r.end(), f));
+}
+
+/**
+ * @brief Conta i valori di una sequenza che soddisfano un predicato
+ *
+ * @tparam Range tipo della sequenza (albero o vista)
+ * @tparam P tipo del predicato
+ * @return std::size_t numero dei valori che soddisfano pred
+ */
+template<typename Range, typename P>
+std::size_t bst_count_if(const Range &r, P pred){
+    std::size_t count = 0;
+    for(typename Range::const_iterator b = r.begin(), e = r.end(); b != e; ++b)
+        if(pred(*b))
+            ++count;
+    return count;
+}
+
+/**
+ * @brief Combina i valori di una sequenza tramite un'operazione binaria
+ *
+ * @tparam Range tipo della sequenza (albero o vista)
+ * @tparam A tipo dell'accumulatore
+ * @tparam Op tipo dell'operazione
+ * @param init valore iniziale dell'accumulatore
+ * @return A risultato di op(...op(op(init, v1), v2)..., vn)
+ */
+template<typename Range, typename A, typename Op>
+A bst_accumulate(const Range &r, A init, Op op){
+    for(typename Range::const_iterator b = r.begin(), e = r.end(); b != e; ++b)
+        init = op(init, *b);
+    return init;
+}
+
+#endif